@@ -0,0 +1,85 @@
+/**
+ * @file alea.c
+ * @author Ferhat BEZTOUT
+ * @brief Générateur pseudo-aléatoire reproductible, sans état global
+ * @version 1.0
+ * @date 2023-04-02
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+#include <stdint.h>
+
+#include "alea.h"
+
+
+/**
+ * @brief étape de splitmix64, utilisée pour dériver l'état initial
+ *
+ * @param x compteur (avancé à chaque appel)
+ * @return uint64_t
+ */
+static uint64_t splitmix64(uint64_t *x)
+{
+    uint64_t z = (*x += 0x9e3779b97f4a7c15ULL);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+}
+
+static uint64_t rotl(uint64_t x, int k)
+{
+    return (x << k) | (x >> (64 - k));
+}
+
+/**
+ * @brief Initialise un générateur. Deux flux différents d'une même graine
+ * donnent des suites indépendantes : le résultat d'un match ne dépend que de
+ * la graine et de son id, quel que soit le thread qui le joue.
+ *
+ * @param a le générateur
+ * @param graine graine maître (--seed)
+ * @param flux numéro du flux
+ */
+void alea_init(alea *a, uint64_t graine, uint64_t flux)
+{
+    uint64_t x = graine ^ splitmix64(&flux);
+    for (int i = 0; i < 4; i++)
+    {
+        a->s[i] = splitmix64(&x);
+    }
+}
+
+/**
+ * @brief Renvoie 64 bits aléatoires (xoshiro256**)
+ *
+ * @param a le générateur
+ * @return uint64_t
+ */
+uint64_t alea_suivant(alea *a)
+{
+    uint64_t *s = a->s;
+    uint64_t resultat = rotl(s[1] * 5, 7) * 9;
+    uint64_t t = s[1] << 17;
+
+    s[2] ^= s[0];
+    s[3] ^= s[1];
+    s[1] ^= s[2];
+    s[0] ^= s[3];
+    s[2] ^= t;
+    s[3] = rotl(s[3], 45);
+
+    return resultat;
+}
+
+/**
+ * @brief Renvoie un entier uniforme dans [0, n[ (multiplication, sans division)
+ *
+ * @param a le générateur
+ * @param n borne
+ * @return uint32_t
+ */
+uint32_t alea_borne(alea *a, uint32_t n)
+{
+    return (uint32_t)(((alea_suivant(a) >> 32) * (uint64_t)n) >> 32);
+}
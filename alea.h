@@ -0,0 +1,25 @@
+/* alea.h */
+#ifndef ALEA_H
+#define ALEA_H
+
+#include <stdint.h>
+
+/* Structures de données */
+
+// Générateur xoshiro256** : un état par match, aucun état partagé entre threads
+typedef struct {
+    uint64_t s[4];
+} alea;
+
+
+/* ============================ Prototypes ============================ */
+// Initialise un générateur à partir de la graine maître et d'un numéro de flux (ex : id du match)
+void alea_init(alea *a, uint64_t graine, uint64_t flux);
+
+// Renvoie 64 bits aléatoires
+uint64_t alea_suivant(alea *a);
+
+// Renvoie un entier uniforme dans [0, n[
+uint32_t alea_borne(alea *a, uint32_t n);
+
+#endif
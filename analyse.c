@@ -0,0 +1,366 @@
+/**
+ * @file analyse.c
+ * @author Ferhat BEZTOUT
+ * @brief Lecture d'une archive de matchs (main --archive F) : résumé par tour,
+ * equipes les plus victorieuses, ou tous les matchs en CSV. L'archive est
+ * projetée en mémoire et parcourue colonne par colonne.
+ * @version 1.0
+ * @date 2023-04-02
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <getopt.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "archive.h"
+
+#define ANALYSE_TOURS 33    // tours suivis (0 à 32)
+
+/* Colonnes d'un bloc de l'archive projetée */
+typedef struct {
+    uint32_t n;
+    const uint64_t *t_ns;
+    const int32_t *num_match;
+    const int32_t *e1;
+    const int32_t *e2;
+    const uint8_t *tour;
+    const uint8_t *score_e1;
+    const uint8_t *score_e2;
+    const uint8_t *drapeaux;
+} bloc;
+
+/* Archive projetée */
+typedef struct {
+    const char *base;
+    size_t taille;
+    const entete_archive *entete;
+    const int32_t *ids;
+    const uint32_t *lgs;
+    const char *noms;
+    size_t *debut_nom;      // position du nom de chaque equipe
+    size_t pos_blocs;       // début du premier bloc
+} archive_lue;
+
+// Victoires par equipe, pour le tri des meilleures
+static const long *victoires_tri;
+
+
+/**
+ * @brief erreur de format : message et sortie
+ *
+ * @param message le message
+ */
+static void invalide(const char *message)
+{
+    fprintf(stderr, "Archive invalide : %s\n", message);
+    exit(EXIT_FAILURE);
+}
+
+/**
+ * @brief projette l'archive et vérifie son en-tête et sa table des equipes
+ *
+ * @param chemin le chemin du fichier
+ * @param a reçoit l'archive
+ */
+static void ouvrir_archive(const char *chemin, archive_lue *a)
+{
+    int fd = open(chemin, O_RDONLY);
+    struct stat st;
+    if (fd == -1 || fstat(fd, &st) != 0)
+    {
+        perror("Erreur d'ouverture fichier");
+        exit(EXIT_FAILURE);
+    }
+    a->taille = (size_t)st.st_size;
+    if (a->taille < sizeof(entete_archive))
+    {
+        invalide("fichier trop court");
+    }
+    a->base = mmap(NULL, a->taille, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (a->base == MAP_FAILED)
+    {
+        perror("Erreur de projection");
+        exit(EXIT_FAILURE);
+    }
+    madvise((void *)a->base, a->taille, MADV_SEQUENTIAL);
+
+    a->entete = (const entete_archive *)a->base;
+    const entete_archive *e = a->entete;
+    if (e->signature != ARCHIVE_SIGNATURE || e->version != ARCHIVE_VERSION || e->nbr_equipes < 0)
+    {
+        invalide("signature ou version");
+    }
+    size_t n = (size_t)e->nbr_equipes;
+    a->pos_blocs = sizeof(entete_archive) + n * (sizeof(int32_t) + sizeof(uint32_t)) + e->taille_noms;
+    a->pos_blocs = (a->pos_blocs + ARCHIVE_ALIGNEMENT - 1) / ARCHIVE_ALIGNEMENT * ARCHIVE_ALIGNEMENT;
+    if (a->pos_blocs > a->taille)
+    {
+        invalide("table des equipes tronquée");
+    }
+    a->ids = (const int32_t *)(a->base + sizeof(entete_archive));
+    a->lgs = (const uint32_t *)(a->ids + n);
+    a->noms = (const char *)(a->lgs + n);
+
+    a->debut_nom = malloc((n + 1) * sizeof(size_t));
+    if (a->debut_nom == NULL)
+    {
+        perror("Erreur allocation memoire");
+        exit(EXIT_FAILURE);
+    }
+    size_t pos = 0;
+    for (size_t i = 0; i < n; i++)
+    {
+        a->debut_nom[i] = pos;
+        pos += a->lgs[i];
+    }
+    if (pos != e->taille_noms)
+    {
+        invalide("longueurs des noms");
+    }
+}
+
+/**
+ * @brief lit le bloc à la position pos
+ *
+ * @param a l'archive
+ * @param pos position du bloc, avancée au bloc suivant
+ * @param b reçoit les colonnes
+ * @return int 0 à la fin de l'archive
+ */
+static int lire_bloc(const archive_lue *a, size_t *pos, bloc *b)
+{
+    if (*pos + sizeof(entete_bloc) > a->taille)
+    {
+        return 0;
+    }
+    const entete_bloc *eb = (const entete_bloc *)(a->base + *pos);
+    size_t n = eb->nbr_lignes;
+    size_t taille = sizeof(entete_bloc) + n * (sizeof(uint64_t) + 3 * sizeof(int32_t) + 4);
+    if (n == 0 || n > a->entete->lignes_bloc || *pos + taille > a->taille)
+    {
+        fprintf(stderr, "Archive tronquée : %zu octets ignorés\n", a->taille - *pos);
+        return 0;
+    }
+    const char *p = (const char *)(eb + 1);
+    b->n = (uint32_t)n;
+    b->t_ns = (const uint64_t *)p;
+    b->num_match = (const int32_t *)(b->t_ns + n);
+    b->e1 = b->num_match + n;
+    b->e2 = b->e1 + n;
+    b->tour = (const uint8_t *)(b->e2 + n);
+    b->score_e1 = b->tour + n;
+    b->score_e2 = b->score_e1 + n;
+    b->drapeaux = b->score_e2 + n;
+    for (size_t i = 0; i < n; i++)
+    {
+        if (b->e1[i] < 0 || b->e1[i] >= a->entete->nbr_equipes || b->e2[i] < 0 || b->e2[i] >= a->entete->nbr_equipes)
+        {
+            invalide("equipe hors de la table");
+        }
+    }
+    *pos += taille;
+    return 1;
+}
+
+/**
+ * @brief écrit le nom d'une equipe (champ CSV entre guillemets)
+ *
+ * @param a l'archive
+ * @param e l'equipe
+ */
+static void ecrire_nom(const archive_lue *a, int32_t e)
+{
+    const char *nom = a->noms + a->debut_nom[e];
+    putchar('"');
+    for (uint32_t i = 0; i < a->lgs[e]; i++)
+    {
+        if (nom[i] == '"')
+        {
+            putchar('"');
+        }
+        putchar(nom[i]);
+    }
+    putchar('"');
+}
+
+/**
+ * @brief tous les matchs en CSV, dans l'ordre de l'archive
+ *
+ * @param a l'archive
+ */
+static void afficher_csv(const archive_lue *a)
+{
+    puts("t_ns,tour,match,e1,e2,score_e1,score_e2,penalties,gagnant");
+    size_t pos = a->pos_blocs;
+    bloc b;
+    while (lire_bloc(a, &pos, &b))
+    {
+        for (uint32_t i = 0; i < b.n; i++)
+        {
+            int32_t g = (b.drapeaux[i] & ARCHIVE_GAGNANT_E2) ? b.e2[i] : b.e1[i];
+            printf("%llu,%d,%d,", (unsigned long long)b.t_ns[i], b.tour[i], b.num_match[i]);
+            ecrire_nom(a, b.e1[i]);
+            putchar(',');
+            ecrire_nom(a, b.e2[i]);
+            printf(",%d,%d,%d,", b.score_e1[i], b.score_e2[i], (b.drapeaux[i] & ARCHIVE_PENALTIES) != 0);
+            ecrire_nom(a, g);
+            putchar('\n');
+        }
+    }
+}
+
+/**
+ * @brief ordre décroissant des victoires (puis ordre de la table)
+ */
+static int comparer_victoires(const void *x, const void *y)
+{
+    int32_t a = *(const int32_t *)x, b = *(const int32_t *)y;
+    if (victoires_tri[a] != victoires_tri[b])
+    {
+        return victoires_tri[a] < victoires_tri[b] ? 1 : -1;
+    }
+    return a - b;
+}
+
+/**
+ * @brief résumé : matchs, buts, penalties et durée par tour, puis les equipes
+ * les plus victorieuses. Chaque boucle ne lit que les colonnes dont elle a besoin.
+ *
+ * @param a l'archive
+ * @param meilleures nombre d'equipes affichées
+ */
+static void afficher_resume(const archive_lue *a, int meilleures)
+{
+    long matchs[ANALYSE_TOURS] = {0}, buts[ANALYSE_TOURS] = {0}, penalties[ANALYSE_TOURS] = {0};
+    uint64_t premier[ANALYSE_TOURS], dernier[ANALYSE_TOURS] = {0};
+    long nbr_equipes = a->entete->nbr_equipes;
+    long *victoires = calloc(nbr_equipes + 1, sizeof(long));
+    if (victoires == NULL)
+    {
+        perror("Erreur allocation memoire");
+        exit(EXIT_FAILURE);
+    }
+    for (int t = 0; t < ANALYSE_TOURS; t++)
+    {
+        premier[t] = UINT64_MAX;
+    }
+
+    long total = 0, blocs = 0;
+    size_t pos = a->pos_blocs;
+    bloc b;
+    while (lire_bloc(a, &pos, &b))
+    {
+        blocs++;
+        total += b.n;
+        for (uint32_t i = 0; i < b.n; i++)
+        {
+            int t = b.tour[i] < ANALYSE_TOURS ? b.tour[i] : ANALYSE_TOURS - 1;
+            matchs[t]++;
+            buts[t] += b.score_e1[i] + b.score_e2[i];
+            penalties[t] += b.drapeaux[i] & ARCHIVE_PENALTIES;
+            premier[t] = b.t_ns[i] < premier[t] ? b.t_ns[i] : premier[t];
+            dernier[t] = b.t_ns[i] > dernier[t] ? b.t_ns[i] : dernier[t];
+        }
+        for (uint32_t i = 0; i < b.n; i++)
+        {
+            int32_t g = (b.drapeaux[i] & ARCHIVE_GAGNANT_E2) ? b.e2[i] : b.e1[i];
+            victoires[g]++;
+        }
+    }
+
+    printf("%ld matchs en %ld blocs, %ld equipes (graine %llu)\n", total, blocs, nbr_equipes,
+           (unsigned long long)a->entete->graine);
+    printf("%-6s %10s %10s %12s %12s %12s\n", "tour", "matchs", "buts/match", "penalties %", "debut (s)", "fin (s)");
+    for (int t = 0; t < ANALYSE_TOURS; t++)
+    {
+        if (matchs[t] == 0)
+        {
+            continue;
+        }
+        printf("%-6d %10ld %10.2f %12.1f %12.3f %12.3f\n", t, matchs[t], (double)buts[t] / matchs[t],
+               100.0 * penalties[t] / matchs[t], premier[t] / 1e9, dernier[t] / 1e9);
+    }
+
+    if (meilleures > nbr_equipes)
+    {
+        meilleures = (int)nbr_equipes;
+    }
+    if (meilleures > 0)
+    {
+        int32_t *ordre = malloc(nbr_equipes * sizeof(int32_t));
+        if (ordre == NULL)
+        {
+            perror("Erreur allocation memoire");
+            exit(EXIT_FAILURE);
+        }
+        for (int32_t e = 0; e < nbr_equipes; e++)
+        {
+            ordre[e] = e;
+        }
+        victoires_tri = victoires;
+        qsort(ordre, nbr_equipes, sizeof(int32_t), comparer_victoires);
+        printf("Equipes les plus victorieuses :\n");
+        for (int i = 0; i < meilleures; i++)
+        {
+            int32_t e = ordre[i];
+            printf("\t%d. %.*s (id %d) : %ld victoires\n", i + 1, (int)a->lgs[e], a->noms + a->debut_nom[e],
+                   a->ids[e], victoires[e]);
+        }
+        free(ordre);
+    }
+    free(victoires);
+}
+
+
+int main(int argc, char *argv[])
+{
+    int csv = 0;
+    int meilleures = 10;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "cn:h")) != -1)
+    {
+        switch (opt)
+        {
+        case 'c':
+            csv = 1;
+            break;
+        case 'n':
+            meilleures = atoi(optarg);
+            break;
+        default:
+            printf("Usage : %s [-c] [-n meilleures] archive\n", argv[0]);
+            puts("  -c   tous les matchs en CSV (sinon : résumé par tour)");
+            puts("  -n   nombre d'equipes les plus victorieuses affichées (10)");
+            return opt == 'h' ? 0 : 1;
+        }
+    }
+    if (optind >= argc)
+    {
+        printf("Usage : %s [-c] [-n meilleures] archive\n", argv[0]);
+        return 1;
+    }
+
+    archive_lue a;
+    ouvrir_archive(argv[optind], &a);
+    if (csv)
+    {
+        afficher_csv(&a);
+    }
+    else
+    {
+        afficher_resume(&a, meilleures);
+    }
+    free(a.debut_nom);
+    munmap((void *)a.base, a.taille);
+    return 0;
+}
@@ -0,0 +1,174 @@
+/**
+ * @file annuaire.c
+ * @author Ferhat BEZTOUT
+ * @brief Index des equipes par nom et par id : une recherche en temps constant
+ * au lieu d'un parcours de la table
+ * @version 1.0
+ * @date 2023-04-02
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "annuaire.h"
+
+
+/**
+ * @brief hachage FNV-1a d'un nom
+ *
+ * @param nom le nom
+ * @param lg sa longueur
+ * @return uint32_t
+ */
+static uint32_t hacher_nom(const char *nom, size_t lg)
+{
+    uint64_t h = 0xcbf29ce484222325ull;
+    for (size_t i = 0; i < lg; i++)
+    {
+        h ^= (unsigned char)nom[i];
+        h *= 0x100000001b3ull;
+    }
+    return (uint32_t)(h ^ (h >> 32));
+}
+
+/**
+ * @brief hachage d'un id (mélange multiplicatif : les ids se suivent)
+ *
+ * @param id l'id
+ * @return uint32_t
+ */
+static uint32_t hacher_id(int id)
+{
+    uint64_t h = (uint64_t)(uint32_t)id * 0x9e3779b97f4a7c15ull;
+    return (uint32_t)(h >> 32);
+}
+
+/**
+ * @brief Construit l'index d'une table d'equipes. Pour un nom ou un id en
+ * double, la premiére equipe de la table est gardée.
+ *
+ * @param t la table des equipes (ne doit plus changer tant que l'index sert)
+ * @return annuaire
+ */
+annuaire annuaire_creer(const table_equipes *t)
+{
+    annuaire a;
+    size_t cases = 16;
+    while (cases < 2 * (size_t)t->nbr)
+    {
+        cases *= 2;
+    }
+    a.equipes = t;
+    a.masque = (uint32_t)(cases - 1);
+    a.par_nom = calloc(cases, sizeof(int32_t));
+    a.par_id = calloc(cases, sizeof(int32_t));
+    if (a.par_nom == NULL || a.par_id == NULL)
+    {
+        perror("Erreur allocation memoire");
+        exit(EXIT_FAILURE);
+    }
+
+    for (Equipe e = 0; e < t->nbr; e++)
+    {
+        if (annuaire_nom(&a, nom_equipe(t, e), lg_nom_equipe(t, e)) < 0)
+        {
+            uint32_t c = hacher_nom(nom_equipe(t, e), lg_nom_equipe(t, e)) & a.masque;
+            while (a.par_nom[c] != 0)
+            {
+                c = (c + 1) & a.masque;
+            }
+            a.par_nom[c] = e + 1;
+        }
+        if (annuaire_id(&a, t->tab[e].id) < 0)
+        {
+            uint32_t c = hacher_id(t->tab[e].id) & a.masque;
+            while (a.par_id[c] != 0)
+            {
+                c = (c + 1) & a.masque;
+            }
+            a.par_id[c] = e + 1;
+        }
+    }
+    return a;
+}
+
+/**
+ * @brief Cherche une equipe par son nom
+ *
+ * @param a l'index
+ * @param nom le nom
+ * @param lg_nom sa longueur
+ * @return Equipe (-1 si aucune)
+ */
+Equipe annuaire_nom(const annuaire *a, const char *nom, size_t lg_nom)
+{
+    const table_equipes *t = a->equipes;
+    for (uint32_t c = hacher_nom(nom, lg_nom) & a->masque; a->par_nom[c] != 0; c = (c + 1) & a->masque)
+    {
+        Equipe e = a->par_nom[c] - 1;
+        if ((size_t)lg_nom_equipe(t, e) == lg_nom && memcmp(nom_equipe(t, e), nom, lg_nom) == 0)
+        {
+            return e;
+        }
+    }
+    return -1;
+}
+
+/**
+ * @brief Cherche une equipe par son id
+ *
+ * @param a l'index
+ * @param id l'id
+ * @return Equipe (-1 si aucune)
+ */
+Equipe annuaire_id(const annuaire *a, int id)
+{
+    for (uint32_t c = hacher_id(id) & a->masque; a->par_id[c] != 0; c = (c + 1) & a->masque)
+    {
+        Equipe e = a->par_id[c] - 1;
+        if (a->equipes->tab[e].id == id)
+        {
+            return e;
+        }
+    }
+    return -1;
+}
+
+/**
+ * @brief Cherche une equipe par son nom, sinon par son id si le texte est un nombre
+ *
+ * @param a l'index
+ * @param texte nom ou id
+ * @return Equipe (-1 si aucune)
+ */
+Equipe annuaire_chercher(const annuaire *a, const char *texte)
+{
+    Equipe e = annuaire_nom(a, texte, strlen(texte));
+    if (e >= 0)
+    {
+        return e;
+    }
+    char *fin;
+    long id = strtol(texte, &fin, 10);
+    if (fin == texte || *fin != '\0')
+    {
+        return -1;
+    }
+    return annuaire_id(a, (int)id);
+}
+
+/**
+ * @brief Libére l'index
+ *
+ * @param a l'index
+ */
+void annuaire_liberer(annuaire *a)
+{
+    free(a->par_nom);
+    free(a->par_id);
+    a->par_nom = NULL;
+    a->par_id = NULL;
+}
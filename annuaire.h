@@ -0,0 +1,38 @@
+/* annuaire.h */
+#ifndef ANNUAIRE_H
+#define ANNUAIRE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "equipes.h"
+
+/* Structures de données */
+
+// Index des equipes par nom et par id : deux tables de hachage à adressage
+// ouvert (sondage linéaire) qui rangent l'indice de l'equipe + 1 (0 = case vide)
+typedef struct {
+    const table_equipes *equipes;
+    uint32_t masque;        // nombre de cases - 1 (puissance de 2, au moins 2 cases par equipe)
+    int32_t *par_nom;
+    int32_t *par_id;
+} annuaire;
+
+
+/* ============================ Prototypes ============================ */
+// Construit l'index d'une table d'equipes (temps linéaire)
+annuaire annuaire_creer(const table_equipes *t);
+
+// Cherche une equipe par son nom ; renvoie -1 si elle n'existe pas
+Equipe annuaire_nom(const annuaire *a, const char *nom, size_t lg_nom);
+
+// Cherche une equipe par son id ; renvoie -1 si elle n'existe pas
+Equipe annuaire_id(const annuaire *a, int id);
+
+// Cherche une equipe par son nom, sinon (texte numérique) par son id ; -1 si aucune
+Equipe annuaire_chercher(const annuaire *a, const char *texte);
+
+// Libére l'index
+void annuaire_liberer(annuaire *a);
+
+#endif
@@ -0,0 +1,229 @@
+/**
+ * @file archive.c
+ * @author Ferhat BEZTOUT
+ * @brief Archive en colonnes des resultats de match : les matchs sont rangés
+ * par blocs de ARCHIVE_LIGNES, colonne par colonne, et chaque bloc part en une
+ * seule écriture depuis le thread écrivain du journal
+ * @version 1.0
+ * @date 2023-04-02
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/uio.h>
+
+#include "archive.h"
+
+struct archive {
+    int fd;
+    uint64_t t0_ns;
+    uint32_t nbr;               // matchs du bloc courant
+
+    // Colonnes du bloc courant (un seul bloc mémoire)
+    uint64_t *t_ns;
+    int32_t *num_match;
+    int32_t *e1;
+    int32_t *e2;
+    uint8_t *tour;
+    uint8_t *score_e1;
+    uint8_t *score_e2;
+    uint8_t *drapeaux;
+};
+
+
+/**
+ * @brief écrit tout un tampon (write peut écrire moins que demandé)
+ *
+ * @param fd le descripteur
+ * @param tampon les octets
+ * @param taille leur nombre
+ */
+static void ecrire_tout(int fd, const void *tampon, size_t taille)
+{
+    const char *p = tampon;
+    while (taille > 0)
+    {
+        ssize_t ecrit = write(fd, p, taille);
+        if (ecrit < 0)
+        {
+            perror("Erreur d'ecriture archive");
+            exit(EXIT_FAILURE);
+        }
+        p += ecrit;
+        taille -= (size_t)ecrit;
+    }
+}
+
+/**
+ * @brief écrit le bloc courant (en-tête puis colonnes) en un seul writev
+ *
+ * @param a l'archive
+ */
+static void ecrire_bloc(archive *a)
+{
+    if (a->nbr == 0)
+    {
+        return;
+    }
+    size_t n = a->nbr;
+    entete_bloc b = {a->nbr, 0};
+    struct iovec iov[9] = {
+        {&b, sizeof(b)},
+        {a->t_ns, n * sizeof(uint64_t)},
+        {a->num_match, n * sizeof(int32_t)},
+        {a->e1, n * sizeof(int32_t)},
+        {a->e2, n * sizeof(int32_t)},
+        {a->tour, n},
+        {a->score_e1, n},
+        {a->score_e2, n},
+        {a->drapeaux, n},
+    };
+    ssize_t ecrit = writev(a->fd, iov, 9);
+    if (ecrit < 0)
+    {
+        perror("Erreur d'ecriture archive");
+        exit(EXIT_FAILURE);
+    }
+
+    // Ecriture partielle (rare) : le reste, morceau par morceau
+    size_t deja = (size_t)ecrit;
+    for (int i = 0; i < 9; i++)
+    {
+        if (deja >= iov[i].iov_len)
+        {
+            deja -= iov[i].iov_len;
+            continue;
+        }
+        ecrire_tout(a->fd, (const char *)iov[i].iov_base + deja, iov[i].iov_len - deja);
+        deja = 0;
+    }
+    a->nbr = 0;
+}
+
+/**
+ * @brief Crée l'archive : en-tête et table des equipes (id et nom), les blocs
+ * de matchs suivent au fil du tournoi
+ *
+ * @param chemin le chemin du fichier
+ * @param t la table des equipes
+ * @param graine graine maître du tournoi
+ * @return archive*
+ */
+archive *archive_creer(const char *chemin, const table_equipes *t, uint64_t graine)
+{
+    archive *a = malloc(sizeof(archive));
+    size_t n = ARCHIVE_LIGNES;
+    char *colonnes = malloc(n * (sizeof(uint64_t) + 3 * sizeof(int32_t) + 4));
+    if (a == NULL || colonnes == NULL)
+    {
+        perror("Erreur allocation memoire");
+        exit(EXIT_FAILURE);
+    }
+    a->t_ns = (uint64_t *)colonnes;
+    a->num_match = (int32_t *)(a->t_ns + n);
+    a->e1 = a->num_match + n;
+    a->e2 = a->e1 + n;
+    a->tour = (uint8_t *)(a->e2 + n);
+    a->score_e1 = a->tour + n;
+    a->score_e2 = a->score_e1 + n;
+    a->drapeaux = a->score_e2 + n;
+    a->nbr = 0;
+
+    a->fd = open(chemin, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (a->fd == -1)
+    {
+        perror("Erreur d'ouverture archive");
+        exit(EXIT_FAILURE);
+    }
+
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    a->t0_ns = (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+
+    entete_archive e;
+    memset(&e, 0, sizeof(e));
+    e.signature = ARCHIVE_SIGNATURE;
+    e.version = ARCHIVE_VERSION;
+    e.graine = graine;
+    e.nbr_equipes = t->nbr;
+    e.lignes_bloc = ARCHIVE_LIGNES;
+    e.t0_ns = a->t0_ns;
+    for (Equipe i = 0; i < t->nbr; i++)
+    {
+        e.taille_noms += t->tab[i].lg_nom;
+    }
+    ecrire_tout(a->fd, &e, sizeof(e));
+
+    // Ids et longueurs, puis noms : une écriture par partie
+    int32_t *ids = malloc(t->nbr * sizeof(int32_t) + 1);
+    uint32_t *lgs = malloc(t->nbr * sizeof(uint32_t) + 1);
+    size_t bourrage = (ARCHIVE_ALIGNEMENT - (e.taille_noms + t->nbr * 8u) % ARCHIVE_ALIGNEMENT) % ARCHIVE_ALIGNEMENT;
+    char *noms = calloc(e.taille_noms + bourrage + 1, 1);
+    if (ids == NULL || lgs == NULL || noms == NULL)
+    {
+        perror("Erreur allocation memoire");
+        exit(EXIT_FAILURE);
+    }
+    size_t pos = 0;
+    for (Equipe i = 0; i < t->nbr; i++)
+    {
+        ids[i] = t->tab[i].id;
+        lgs[i] = t->tab[i].lg_nom;
+        memcpy(noms + pos, nom_equipe(t, i), lgs[i]);
+        pos += lgs[i];
+    }
+    ecrire_tout(a->fd, ids, t->nbr * sizeof(int32_t));
+    ecrire_tout(a->fd, lgs, t->nbr * sizeof(uint32_t));
+    ecrire_tout(a->fd, noms, pos + bourrage);
+    free(ids);
+    free(lgs);
+    free(noms);
+    return a;
+}
+
+/**
+ * @brief Ajoute le resultat d'un match au bloc courant ; un bloc plein part
+ * sur disque. Appelé par le thread écrivain du journal seulement.
+ *
+ * @param a l'archive
+ * @param ev l'evenement EV_GAGNANT ou EV_PENALTIES du match
+ */
+void archive_ajouter(archive *a, const evenement *ev)
+{
+    uint32_t i = a->nbr;
+    a->t_ns[i] = (ev->t_ns > a->t0_ns) ? ev->t_ns - a->t0_ns : 0;
+    a->num_match[i] = ev->num_match;
+    a->e1[i] = ev->e1;
+    a->e2[i] = ev->e2;
+    a->tour[i] = (uint8_t)ev->tour;
+    a->score_e1[i] = ev->score_e1;
+    a->score_e2[i] = ev->score_e2;
+    a->drapeaux[i] = (ev->type == EV_PENALTIES ? ARCHIVE_PENALTIES : 0) |
+                     (ev->equipe == ev->e2 && ev->e1 != ev->e2 ? ARCHIVE_GAGNANT_E2 : 0);
+    if (++a->nbr == ARCHIVE_LIGNES)
+    {
+        ecrire_bloc(a);
+    }
+}
+
+/**
+ * @brief Ecrit le dernier bloc (incomplet) et ferme l'archive
+ *
+ * @param a l'archive
+ */
+void archive_fermer(archive *a)
+{
+    ecrire_bloc(a);
+    if (close(a->fd) != 0)
+    {
+        perror("Erreur d'ecriture archive");
+    }
+    free(a->t_ns);
+    free(a);
+}
@@ -0,0 +1,58 @@
+/* archive.h */
+#ifndef ARCHIVE_H
+#define ARCHIVE_H
+
+#include <stdint.h>
+
+#include "equipes.h"
+#include "journal.h"
+
+/* Définitions des constantes */
+#define ARCHIVE_SIGNATURE 0x41524e54    // "TNRA"
+#define ARCHIVE_VERSION 1
+#define ARCHIVE_LIGNES 65536            // matchs par bloc de colonnes
+#define ARCHIVE_ALIGNEMENT 8            // alignement des blocs dans le fichier
+
+// Drapeaux d'un match
+#define ARCHIVE_PENALTIES 1             // score nul, gagné aux penalties
+#define ARCHIVE_GAGNANT_E2 2            // e2 a gagné
+
+/* Structures de données */
+
+// En-tête de l'archive, suivi de l'id (int32) et de la longueur du nom (uint32)
+// de chaque equipe, des noms bout à bout (complétés de zéros jusqu'à un multiple
+// de 8 octets : les colonnes restent alignées), puis des blocs de colonnes
+typedef struct {
+    uint32_t signature;
+    uint32_t version;
+    uint64_t graine;
+    int32_t nbr_equipes;
+    uint32_t lignes_bloc;   // ARCHIVE_LIGNES : taille maximale d'un bloc
+    uint64_t taille_noms;
+    uint64_t t0_ns;         // origine des dates des matchs (horloge monotone)
+} entete_archive;
+
+// En-tête d'un bloc de n matchs, suivi des colonnes dans cet ordre :
+// t_ns uint64[n], num_match int32[n], e1 int32[n], e2 int32[n],
+// tour uint8[n], score_e1 uint8[n], score_e2 uint8[n], drapeaux uint8[n]
+// (e1 et e2 sont des indices dans la table des equipes de l'archive)
+typedef struct {
+    uint32_t nbr_lignes;
+    uint32_t reserve;
+} entete_bloc;
+
+// Archive en cours d'écriture (remplie par le thread écrivain du journal)
+typedef struct archive archive;
+
+
+/* ============================ Prototypes ============================ */
+// Crée l'archive (en-tête, equipes) ; les matchs y sont ajoutés par le journal
+archive *archive_creer(const char *chemin, const table_equipes *t, uint64_t graine);
+
+// Ajoute le resultat d'un match (EV_GAGNANT ou EV_PENALTIES) au bloc courant
+void archive_ajouter(archive *a, const evenement *ev);
+
+// Ecrit le dernier bloc et ferme l'archive
+void archive_fermer(archive *a);
+
+#endif
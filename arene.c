@@ -0,0 +1,79 @@
+/**
+ * @file arene.c
+ * @author Ferhat BEZTOUT
+ * @brief Arène mémoire : un seul malloc pour toutes les structures d'un tournoi
+ * @version 1.0
+ * @date 2023-04-02
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "arene.h"
+
+
+/**
+ * @brief Taille réservée dans l'arène pour un bloc (arrondie à l'alignement)
+ *
+ * @param taille taille demandée
+ * @return size_t
+ */
+size_t arene_taille_bloc(size_t taille)
+{
+    return (taille + ARENE_ALIGNEMENT - 1) & ~(size_t)(ARENE_ALIGNEMENT - 1);
+}
+
+/**
+ * @brief Crée une arène d'une capacité fixe
+ *
+ * @param capacite capacité en octets (somme des arene_taille_bloc des blocs prévus)
+ * @return arene
+ */
+arene arene_creer(size_t capacite)
+{
+    arene a;
+    a.taille = 0;
+    a.capacite = arene_taille_bloc(capacite);
+    a.base = aligned_alloc(ARENE_ALIGNEMENT, a.capacite > 0 ? a.capacite : ARENE_ALIGNEMENT);
+    if (a.base == NULL)
+    {
+        perror("Erreur allocation memoire");
+        exit(EXIT_FAILURE);
+    }
+    return a;
+}
+
+/**
+ * @brief Alloue un bloc aligné sur ARENE_ALIGNEMENT (non initialisé)
+ *
+ * @param a l'arène
+ * @param taille taille du bloc
+ * @return void*
+ */
+void *arene_allouer(arene *a, size_t taille)
+{
+    size_t reserve = arene_taille_bloc(taille);
+    if (reserve > a->capacite - a->taille)
+    {
+        fprintf(stderr, "Erreur arene pleine (%zu octets demandés, %zu libres)\n", taille, a->capacite - a->taille);
+        exit(EXIT_FAILURE);
+    }
+    void *bloc = a->base + a->taille;
+    a->taille += reserve;
+    return bloc;
+}
+
+/**
+ * @brief Libére la mémoire de l'arène
+ *
+ * @param a l'arène
+ */
+void arene_liberer(arene *a)
+{
+    free(a->base);
+    a->base = NULL;
+    a->taille = 0;
+    a->capacite = 0;
+}
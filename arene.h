@@ -0,0 +1,33 @@
+/* arene.h */
+#ifndef ARENE_H
+#define ARENE_H
+
+#include <stddef.h>
+
+/* Définitions des constantes */
+#define ARENE_ALIGNEMENT 64     // chaque bloc commence sur une ligne de cache
+
+/* Structures de données */
+
+// Arène à capacité fixe : allouer = avancer un indice, tout est libéré d'un coup
+typedef struct {
+    char *base;
+    size_t taille;      // octets déjà alloués
+    size_t capacite;
+} arene;
+
+
+/* ============================ Prototypes ============================ */
+// Taille réservée dans l'arène pour un bloc de taille octets (alignement compris)
+size_t arene_taille_bloc(size_t taille);
+
+// Crée une arène d'une capacité fixe (un seul malloc)
+arene arene_creer(size_t capacite);
+
+// Alloue un bloc aligné dans l'arène (erreur fatale si elle est pleine)
+void *arene_allouer(arene *a, size_t taille);
+
+// Libére toute la mémoire de l'arène
+void arene_liberer(arene *a);
+
+#endif
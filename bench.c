@@ -0,0 +1,220 @@
+/**
+ * @file bench.c
+ * @author Ferhat BEZTOUT
+ * @brief Banc d'essai : chargement des equipes, mise en place du tournoi,
+ * débit de simuler_match et du noyau, durée d'un tournoi complet.
+ * Une ligne JSON par mesure sur la sortie standard (make bench && ./bench > resultats.jsonl)
+ * @version 1.0
+ * @date 2023-04-02
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <getopt.h>
+
+#include "main.h"
+#include "pool.h"
+#include "noyau.h"
+
+static volatile long puits;     // empêche le compilateur d'éliminer les matchs mesurés
+
+
+/**
+ * @brief date courante de l'horloge monotone en secondes
+ *
+ * @return double
+ */
+static double maintenant(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/**
+ * @brief écrit une mesure sur une ligne JSON
+ *
+ * @param mesure nom de la mesure
+ * @param equipes nombre d'equipes
+ * @param nbr nombre d'opérations mesurées
+ * @param secondes durée
+ */
+static void resultat(const char *mesure, int equipes, long nbr, double secondes)
+{
+    printf("{\"mesure\":\"%s\",\"equipes\":%d,\"operations\":%ld,\"secondes\":%.6f,\"par_seconde\":%.1f}\n",
+           mesure, equipes, nbr, secondes, nbr / secondes);
+    fflush(stdout);
+}
+
+/**
+ * @brief écrit un fichier temporaire de n equipes (une par ligne)
+ *
+ * @param n nombre d'equipes
+ * @param chemin chemin du fichier créé (modèle mkstemp)
+ */
+static void ecrire_fichier_equipes(int n, char *chemin)
+{
+    int fd = mkstemp(chemin);
+    FILE *f = (fd == -1) ? NULL : fdopen(fd, "w");
+    if (f == NULL)
+    {
+        perror("Erreur creation fichier temporaire");
+        exit(EXIT_FAILURE);
+    }
+    for (int i = 0; i < n; i++)
+    {
+        fprintf(f, "equipe%d\n", i + 1);
+    }
+    fclose(f);
+}
+
+/**
+ * @brief mesure toutes les étapes pour 2^exposant equipes
+ *
+ * @param exposant taille du tournoi en puissance de 2
+ * @param p le pool de workers
+ */
+static void mesurer(int exposant, pool *p)
+{
+    int n = 1 << exposant;
+    char chemin[] = "/tmp/bench_equipesXXXXXX";
+    ecrire_fichier_equipes(n, chemin);
+
+    // Chargement
+    double debut = maintenant();
+    mes_equipes = nouvelle_table_equipes(0);
+    read_teams(chemin, &mes_equipes);
+    resultat("read_teams", n, n, maintenant() - debut);
+    unlink(chemin);
+    team_count = mes_equipes.nbr;
+    nbr_tours = exposant;
+
+    // Mise en place du tournoi
+    debut = maintenant();
+    mon_tournoi = nouveau_tournoi(nbr_tours);
+    start_tournoi(&mon_tournoi, &mes_equipes);
+    resultat("nouveau_tournoi+start_tournoi", n, n, maintenant() - debut);
+
+    // Tournoi complet (n - 1 matchs), sans attente
+    debut = maintenant();
+    simuler_tournoi(p);
+    resultat("tournoi", n, n - 1, maintenant() - debut);
+
+    // Même tournoi rejoué : l'arène est réutilisée, aucune allocation
+    debut = maintenant();
+    reinitialiser_tournoi(&mon_tournoi);
+    simuler_tournoi(p);
+    resultat("tournoi_rejoue", n, n - 1, maintenant() - debut);
+
+    // Et si : un match du tour 0 renversé, seul son chemin est rejoué
+    long rejoues = 0;
+    debut = maintenant();
+    for (int i = 0; i < 1000; i++)
+    {
+        rejoues += renverser_match(0, (int)((i * 2654435761u) % (unsigned)(n / 2)));
+    }
+    resultat("renverser_match", n, 1000, maintenant() - debut);
+    puits = rejoues;
+
+    liberer_equipe_tournoi(mon_tournoi);
+    liberer_table_equipes(&mes_equipes);
+}
+
+/**
+ * @brief mesure le débit de simuler_match seul (sans attente ni journal)
+ *
+ * @param nbr nombre de matchs
+ */
+static void mesurer_match(long nbr)
+{
+    mes_equipes = nouvelle_table_equipes(2);
+    ajouter_equipe(&mes_equipes, "A", 1);
+    ajouter_equipe(&mes_equipes, "B", 1);
+    nbr_tours = 1;
+    mon_tournoi = nouveau_tournoi(nbr_tours);
+
+    double debut = maintenant();
+    long gagnes = 0;
+    for (long i = 0; i < nbr; i++)
+    {
+        gagnes += simuler_match(0, 1, 0, 0);
+        graine++;
+    }
+    resultat("simuler_match", 2, nbr, maintenant() - debut);
+    puits = gagnes;
+
+    liberer_equipe_tournoi(mon_tournoi);
+    liberer_table_equipes(&mes_equipes);
+}
+
+/**
+ * @brief mesure le débit du noyau vectorisé (matchs joués par seconde, toutes voies)
+ *
+ * @param nbr nombre de matchs par voie
+ */
+static void mesurer_noyau(int nbr)
+{
+    noyau_alea g;
+    uint8_t *gagnant = malloc((size_t)nbr * NOYAU_VOIES);
+    noyau_init(&g, graine, 0);
+
+    double debut = maintenant();
+    noyau_tour(&g, nbr, NULL, gagnant, NULL, NULL);
+    double duree = maintenant() - debut;
+
+    printf("{\"mesure\":\"noyau_tour\",\"isa\":\"%s\",\"equipes\":2,\"operations\":%ld,\"secondes\":%.6f,\"par_seconde\":%.1f}\n",
+           noyau_isa(), (long)nbr * NOYAU_VOIES, duree, (long)nbr * NOYAU_VOIES / duree);
+    free(gagnant);
+}
+
+
+int main(int argc, char *argv[])
+{
+    int min = 10;
+    int max = 24;
+    int pas = 2;
+    int nbr_workers = 0;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "m:M:p:j:h")) != -1)
+    {
+        switch (opt)
+        {
+        case 'm':
+            min = atoi(optarg);
+            break;
+        case 'M':
+            max = atoi(optarg);
+            break;
+        case 'p':
+            pas = atoi(optarg) > 0 ? atoi(optarg) : 1;
+            break;
+        case 'j':
+            nbr_workers = atoi(optarg);
+            break;
+        default:
+            printf("Usage : %s [-m exposant_min] [-M exposant_max] [-p pas] [-j workers]\n", argv[0]);
+            return opt == 'h' ? 0 : 1;
+        }
+    }
+
+    vitesse = 0;    // temps simulé : aucune attente
+    graine = 1;
+
+    mesurer_match(1000000);
+    mesurer_noyau(1000000);
+
+    pool *p = pool_creer(nbr_workers);
+    for (int exposant = min; exposant <= max; exposant += pas)
+    {
+        mesurer(exposant, p);
+    }
+    pool_detruire(p);
+    return 0;
+}
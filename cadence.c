@@ -0,0 +1,355 @@
+/**
+ * @file cadence.c
+ * @author Ferhat BEZTOUT
+ * @brief Matchs en temps réel sans un thread par match : quelques boucles
+ * d'evenements jouent les matchs action par action, une roue de temporisation
+ * par boucle date l'action suivante de chaque match
+ * @version 1.0
+ * @date 2023-04-02
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <time.h>
+#include <pthread.h>
+
+#include "main.h"
+#include "cadence.h"
+#include "mesures.h"
+#include "progression.h"
+
+/* Un match en cours : quelques dizaines d'octets au lieu d'une pile de thread */
+typedef struct vivant {
+    struct vivant *suivant;     // case de la roue ou boîte de la boucle
+    match *m;
+    uint64_t echeance;          // tic de l'action suivante
+    uint64_t debut_ns;          // coup d'envoi (mesures)
+    partie p;
+} vivant;
+
+/* Une boucle d'evenements et sa roue */
+typedef struct {
+    pthread_t thread;
+    pthread_mutex_t verrou;     // protège boite et arret
+    pthread_cond_t reveil;
+    vivant *boite;              // matchs confiés par les autres threads
+    int arret;
+
+    // Propres au thread de la boucle : aucun verrou
+    vivant *roue[CADENCE_CASES];
+    long nbr_vivants;
+    uint64_t tic;               // prochain tic à traiter
+} boucle;
+
+static boucle *boucles;
+static int nbr_boucles;
+static atomic_uint prochaine_boucle;
+
+// Un état par match de l'arbre (id_match) : aprés une reprise, un match peut
+// être en cours en même temps qu'un match de son propre sous arbre.
+static vivant *vivants;
+
+// Matchs confiés ou en cours, pour cadence_attendre
+static long en_cours;
+static pthread_mutex_t verrou_fin = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t tout_fini = PTHREAD_COND_INITIALIZER;
+
+
+/**
+ * @brief date courante de l'horloge monotone en nanosecondes
+ *
+ * @return uint64_t
+ */
+static uint64_t maintenant(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+/**
+ * @brief range un match dans la case de son échéance
+ *
+ * @param b la boucle
+ * @param v le match
+ * @param echeance_ns date de l'action suivante
+ */
+static void planifier(boucle *b, vivant *v, uint64_t echeance_ns)
+{
+    v->echeance = (echeance_ns + CADENCE_TIC_NS - 1) / CADENCE_TIC_NS;
+    if (v->echeance < b->tic)
+    {
+        v->echeance = b->tic;
+    }
+    vivant **c = &b->roue[v->echeance & (CADENCE_CASES - 1)];
+    v->suivant = *c;
+    *c = v;
+}
+
+/**
+ * @brief joue une action d'un match puis le range à la date de la suivante
+ *
+ * @param b la boucle
+ * @param v le match
+ * @param t date courante
+ */
+static void jouer_action(boucle *b, vivant *v, uint64_t t)
+{
+    int duree_us = partie_action(&v->p);
+    planifier(b, v, t + (uint64_t)(duree_us * 1000.0 / vitesse));
+}
+
+/**
+ * @brief coup d'envoi d'un match jouable et sa premiére action
+ *
+ * @param b la boucle
+ * @param m le match (ses deux equipes sont connues)
+ * @param t date courante
+ */
+static void demarrer(boucle *b, match *m, uint64_t t)
+{
+    vivant *v = &vivants[id_match(m->num_tour, m->num_match)];
+    int tour = m->num_tour;
+    v->m = m;
+    v->debut_ns = t;
+    if (mesures_actives())
+    {
+        mesure_ajouter(MESURE_ATTENTE_FILE, tour, t - m->pret_ns);
+    }
+    if (progression_active())
+    {
+        progression_debut_match();
+    }
+    partie_debut(&v->p, pop_equipe_at_tour(&mon_tournoi, tour, 2 * m->num_match),
+                 pop_equipe_at_tour(&mon_tournoi, tour, 2 * m->num_match + 1), tour, m->num_match);
+    b->nbr_vivants++;
+    jouer_action(b, v, t);
+}
+
+/**
+ * @brief fait avancer un match arrivé à échéance : action suivante, ou fin du
+ * match et coup d'envoi du match suivant s'il devient jouable (sur cette boucle)
+ *
+ * @param b la boucle
+ * @param v le match
+ * @param t date courante
+ */
+static void avancer(boucle *b, vivant *v, uint64_t t)
+{
+    if (v->p.temps < DUREE_MATCH)
+    {
+        jouer_action(b, v, t);
+        return;
+    }
+
+    Equipe eg = partie_fin(&v->p);
+    if (mesures_actives())
+    {
+        mesure_ajouter(MESURE_DUREE_MATCH, v->p.tour, t - v->debut_ns);
+    }
+    if (progression_active())
+    {
+        progression_fin_match(v->p.tour);
+    }
+    b->nbr_vivants--;
+
+    match *suivant = qualifier(v->m, v->p.e1, v->p.e2, eg, t);
+    if (suivant != NULL)
+    {
+        demarrer(b, suivant, t);
+        return;
+    }
+    pthread_mutex_lock(&verrou_fin);
+    if (--en_cours == 0)
+    {
+        pthread_cond_broadcast(&tout_fini);
+    }
+    pthread_mutex_unlock(&verrou_fin);
+}
+
+/**
+ * @brief traite les tics écoulés : chaque case parcourue ne garde que les
+ * matchs dont l'échéance est à un tour de roue ou plus
+ *
+ * @param b la boucle
+ * @param t date courante
+ */
+static void tourner(boucle *b, uint64_t t)
+{
+    uint64_t tic = t / CADENCE_TIC_NS;
+    for (; b->tic <= tic; b->tic++)
+    {
+        vivant **c = &b->roue[b->tic & (CADENCE_CASES - 1)];
+        vivant *v = *c;
+        *c = NULL;
+        while (v != NULL)
+        {
+            vivant *suivant = v->suivant;
+            if (v->echeance <= b->tic)
+            {
+                avancer(b, v, t);
+            }
+            else
+            {
+                v->suivant = *c;
+                *c = v;
+            }
+            v = suivant;
+        }
+    }
+}
+
+/**
+ * @brief Thread d'une boucle : prend les matchs de sa boîte, fait tourner la
+ * roue, puis dort jusqu'au tic suivant (ou jusqu'à un nouveau match s'il n'a
+ * plus de match en cours)
+ *
+ * @param arg la boucle
+ * @return void*
+ */
+static void *thread_boucle(void *arg)
+{
+    boucle *b = (boucle *)arg;
+    b->tic = maintenant() / CADENCE_TIC_NS;
+
+    pthread_mutex_lock(&b->verrou);
+    while (!b->arret || b->boite != NULL)
+    {
+        vivant *boite = b->boite;
+        b->boite = NULL;
+        pthread_mutex_unlock(&b->verrou);
+
+        uint64_t t = maintenant();
+        if (b->nbr_vivants == 0)
+        {
+            b->tic = t / CADENCE_TIC_NS;    // roue vide : rien à rattraper
+        }
+        for (vivant *v = boite, *suivant; v != NULL; v = suivant)
+        {
+            suivant = v->suivant;
+            demarrer(b, v->m, t);
+        }
+        tourner(b, t);
+
+        pthread_mutex_lock(&b->verrou);
+        if (b->boite != NULL || b->arret)
+        {
+            continue;
+        }
+        if (b->nbr_vivants == 0)
+        {
+            pthread_cond_wait(&b->reveil, &b->verrou);
+        }
+        else
+        {
+            uint64_t reveil_ns = b->tic * CADENCE_TIC_NS;
+            struct timespec ts = {(time_t)(reveil_ns / 1000000000u), (long)(reveil_ns % 1000000000u)};
+            pthread_cond_timedwait(&b->reveil, &b->verrou, &ts);
+        }
+    }
+    pthread_mutex_unlock(&b->verrou);
+    return NULL;
+}
+
+/**
+ * @brief Démarre les boucles d'evenements. Chaque boucle tient ses matchs en
+ * cours dans sa roue de temporisation : un match ne coûte qu'un état (vivant)
+ * et une case de la roue, le nombre de matchs simultanés n'est plus borné
+ * par le nombre de threads.
+ *
+ * @param nbr nombre de boucles (au moins 1)
+ * @param nbr_matchs nombre d'etats à prévoir : les matchs de l'arbre (taille - 1)
+ */
+void cadence_demarrer(int nbr, int nbr_matchs)
+{
+    nbr_boucles = (nbr > 0) ? nbr : 1;
+    boucles = calloc(nbr_boucles, sizeof(boucle));
+    vivants = calloc(nbr_matchs > 0 ? nbr_matchs : 1, sizeof(vivant));
+    if (boucles == NULL || vivants == NULL)
+    {
+        perror("Erreur allocation memoire");
+        exit(EXIT_FAILURE);
+    }
+    atomic_init(&prochaine_boucle, 0);
+    en_cours = 0;
+
+    pthread_condattr_t attr;
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    for (int i = 0; i < nbr_boucles; i++)
+    {
+        pthread_mutex_init(&boucles[i].verrou, NULL);
+        pthread_cond_init(&boucles[i].reveil, &attr);
+        if (pthread_create(&boucles[i].thread, NULL, thread_boucle, &boucles[i]) != 0)
+        {
+            perror("Erreur creation thread");
+            exit(EXIT_FAILURE);
+        }
+    }
+    pthread_condattr_destroy(&attr);
+}
+
+/**
+ * @brief Confie un match jouable à une boucle (à tour de rôle). Les matchs
+ * qu'il rend jouables restent sur la même boucle.
+ *
+ * @param arg le match
+ */
+void cadence_soumettre(void *arg)
+{
+    match *m = (match *)arg;
+    vivant *v = &vivants[id_match(m->num_tour, m->num_match)];
+    boucle *b = &boucles[atomic_fetch_add(&prochaine_boucle, 1) % nbr_boucles];
+    v->m = m;
+
+    pthread_mutex_lock(&verrou_fin);
+    en_cours++;
+    pthread_mutex_unlock(&verrou_fin);
+
+    pthread_mutex_lock(&b->verrou);
+    v->suivant = b->boite;
+    b->boite = v;
+    pthread_cond_signal(&b->reveil);
+    pthread_mutex_unlock(&b->verrou);
+}
+
+/**
+ * @brief Attend que tous les matchs confiés soient joués, ainsi que ceux
+ * qu'ils ont rendus jouables
+ */
+void cadence_attendre(void)
+{
+    pthread_mutex_lock(&verrou_fin);
+    while (en_cours > 0)
+    {
+        pthread_cond_wait(&tout_fini, &verrou_fin);
+    }
+    pthread_mutex_unlock(&verrou_fin);
+}
+
+/**
+ * @brief Arrête les boucles (aprés cadence_attendre) et libére les états
+ */
+void cadence_arreter(void)
+{
+    for (int i = 0; i < nbr_boucles; i++)
+    {
+        pthread_mutex_lock(&boucles[i].verrou);
+        boucles[i].arret = 1;
+        pthread_cond_signal(&boucles[i].reveil);
+        pthread_mutex_unlock(&boucles[i].verrou);
+    }
+    for (int i = 0; i < nbr_boucles; i++)
+    {
+        pthread_join(boucles[i].thread, NULL);
+        pthread_mutex_destroy(&boucles[i].verrou);
+        pthread_cond_destroy(&boucles[i].reveil);
+    }
+    free(boucles);
+    free(vivants);
+    boucles = NULL;
+    vivants = NULL;
+}
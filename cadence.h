@@ -0,0 +1,24 @@
+/* cadence.h */
+#ifndef CADENCE_H
+#define CADENCE_H
+
+/* Définitions des constantes */
+#define CADENCE_TIC_NS 1000000      // résolution de la roue de temporisation (1 ms)
+#define CADENCE_CASES 4096          // cases de la roue (puissance de 2) : ~4 s avant un tour complet
+
+
+/* ============================ Prototypes ============================ */
+// Démarre nbr_boucles boucles d'evenements qui cadencent les matchs en temps réel
+// (nbr_matchs : les matchs de l'arbre, taille - 1)
+void cadence_demarrer(int nbr_boucles, int nbr_matchs);
+
+// Confie un match jouable (struct match de main.h) à une boucle
+void cadence_soumettre(void *m);
+
+// Attend que tous les matchs confiés, et ceux qu'ils rendent jouables, soient joués
+void cadence_attendre(void);
+
+// Arrête les boucles et libére les états des matchs
+void cadence_arreter(void);
+
+#endif
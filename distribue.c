@@ -0,0 +1,337 @@
+/**
+ * @file distribue.c
+ * @author Ferhat BEZTOUT
+ * @brief Mode coordinateur / processus : les premiers tours sont découpés en
+ * sous arbres joués chacun par un processus fils, les qualifiés reviennent au
+ * coordinateur par une socket UNIX qui joue les derniers tours. Les evenements
+ * des fils suivent le même chemin vers les fichiers du coordinateur.
+ * @version 1.0
+ * @date 2023-04-02
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+
+#include "main.h"
+#include "pool.h"
+#include "journal.h"
+#include "distribue.h"
+
+/* En-tête d'un envoi : nombre equipes qualifiées au tour tour, à partir de la place premiere,
+ * suivies des resultats des matchs du tour precedent qui les ont qualifiées */
+typedef struct {
+    int32_t tour;
+    int32_t premiere;
+    int32_t nombre;
+} envoi;
+
+
+/**
+ * @brief écrit tout un tampon sur une socket (écritures partielles comprises)
+ *
+ * @param fd la socket
+ * @param tampon les données
+ * @param taille leur taille
+ */
+static void ecrire_tout(int fd, const void *tampon, size_t taille)
+{
+    const char *p = tampon;
+    while (taille > 0)
+    {
+        ssize_t n = write(fd, p, taille);
+        if (n <= 0)
+        {
+            perror("Erreur d'ecriture socket");
+            _exit(EXIT_FAILURE);
+        }
+        p += n;
+        taille -= (size_t)n;
+    }
+}
+
+/**
+ * @brief lit exactement taille octets d'une socket
+ *
+ * @param fd la socket
+ * @param tampon destination
+ * @param taille taille attendue
+ * @return int 0 si tout est lu, -1 si la socket est fermée avant
+ */
+static int lire_tout(int fd, void *tampon, size_t taille)
+{
+    char *p = tampon;
+    while (taille > 0)
+    {
+        ssize_t n = read(fd, p, taille);
+        if (n <= 0)
+        {
+            return -1;
+        }
+        p += n;
+        taille -= (size_t)n;
+    }
+    return 0;
+}
+
+/**
+ * @brief processus fils : envoie les evenements que son journal a écrits dans
+ * le fichier temporaire (format de --bin), précédés de leur nombre
+ *
+ * @param fd la socket vers le coordinateur
+ * @param chemin le fichier temporaire, supprimé ensuite
+ */
+static void envoyer_evenements(int fd, const char *chemin)
+{
+    FILE *f = fopen(chemin, "rb");
+    if (f == NULL || fseek(f, 0, SEEK_END) != 0)
+    {
+        perror("Erreur de lecture evenements");
+        _exit(EXIT_FAILURE);
+    }
+    long taille = ftell(f);
+    uint64_t nbr = (taille > JOURNAL_ENTETE_BIN) ? (uint64_t)(taille - JOURNAL_ENTETE_BIN) / sizeof(evenement) : 0;
+    ecrire_tout(fd, &nbr, sizeof(nbr));
+
+    evenement tampon[1024];
+    fseek(f, JOURNAL_ENTETE_BIN, SEEK_SET);
+    while (nbr > 0)
+    {
+        size_t n = fread(tampon, sizeof(evenement), nbr < 1024 ? nbr : 1024, f);
+        if (n == 0)
+        {
+            perror("Erreur de lecture evenements");
+            _exit(EXIT_FAILURE);
+        }
+        ecrire_tout(fd, tampon, n * sizeof(evenement));
+        nbr -= n;
+    }
+    fclose(f);
+    unlink(chemin);
+}
+
+/**
+ * @brief processus fils : joue les tours [0, tour_fin) de son sous arbre avec
+ * son propre pool et son propre journal, puis envoie tour par tour les
+ * equipes qualifiées de son bloc, puis les evenements voulus par le coordinateur
+ *
+ * @param fd la socket vers le coordinateur
+ * @param num_bloc le sous arbre joué
+ * @param nbr_processus nombre de sous arbres
+ * @param tour_fin premier tour joué par le coordinateur
+ * @param nbr_workers workers du pool de ce processus
+ * @param niveau niveau du journal
+ * @param transfert niveau maximal des evenements renvoyés, -1 pour aucun
+ */
+static void processus_fils(int fd, int num_bloc, int nbr_processus, int tour_fin, int nbr_workers, int niveau,
+                           int transfert)
+{
+    setvbuf(stdout, NULL, _IOLBF, 0);  // lignes entiéres : pas de mélange entre processus
+
+    // Les evenements à renvoyer passent par un fichier temporaire : le fils
+    // joue sans attendre que le coordinateur lise sa socket
+    char chemin[] = "/tmp/tournoi-evenements-XXXXXX";
+    if (transfert >= 0)
+    {
+        int tmp = mkstemp(chemin);
+        if (tmp == -1)
+        {
+            perror("Erreur creation fichier temporaire");
+            _exit(EXIT_FAILURE);
+        }
+        close(tmp);
+    }
+    journal_ouvrir(&mes_equipes, niveau, transfert, NULL, (transfert >= 0) ? chemin : NULL, NULL, NULL);
+    pool *p = pool_creer(nbr_workers);
+    simuler_tours(p, 0, tour_fin, num_bloc, nbr_processus);
+    pool_detruire(p);
+    journal_fermer();
+
+    for (int tour = 1; tour <= tour_fin; tour++)
+    {
+        int nombre = (mon_tournoi.taille >> tour) / nbr_processus;
+        envoi e = {tour, num_bloc * nombre, nombre};
+        ecrire_tout(fd, &e, sizeof(e));
+        ecrire_tout(fd, mon_tournoi.tour[tour] + e.premiere, nombre * sizeof(Equipe));
+        ecrire_tout(fd, mon_tournoi.resultats + id_match(tour - 1, e.premiere), nombre * sizeof(resultat_match));
+    }
+    if (transfert >= 0)
+    {
+        envoyer_evenements(fd, chemin);
+    }
+    close(fd);
+    fflush(stdout);
+    _exit(EXIT_SUCCESS);
+}
+
+/**
+ * @brief reçoit les evenements d'un processus fils à la suite de ceux déjà reçus
+ *
+ * @param fd la socket du fils
+ * @param ev les evenements reçus (réalloué)
+ * @return int 0 si tout est reçu, -1 sinon
+ */
+static int recevoir_evenements(int fd, evenements_fils *ev)
+{
+    uint64_t nbr;
+    if (lire_tout(fd, &nbr, sizeof(nbr)) != 0)
+    {
+        return -1;
+    }
+    evenement *tab = realloc(ev->tab, (ev->nbr + nbr) * sizeof(evenement) + 1);
+    if (tab == NULL)
+    {
+        perror("Erreur allocation memoire");
+        exit(EXIT_FAILURE);
+    }
+    ev->tab = tab;
+    if (lire_tout(fd, ev->tab + ev->nbr, nbr * sizeof(evenement)) != 0)
+    {
+        return -1;
+    }
+    ev->nbr += (long)nbr;
+    return 0;
+}
+
+/**
+ * @brief reçoit les qualifiés d'un processus fils et les resultats de ses
+ * matchs dans mon_tournoi
+ *
+ * @param fd la socket du fils
+ * @param tour_fin dernier tour envoyé
+ * @return int 0 si tout est reçu, -1 sinon
+ */
+static int recevoir(int fd, int tour_fin)
+{
+    for (int i = 1; i <= tour_fin; i++)
+    {
+        envoi e;
+        if (lire_tout(fd, &e, sizeof(e)) != 0)
+        {
+            return -1;
+        }
+        if (e.tour < 1 || e.tour > tour_fin || e.nombre < 0 || e.premiere < 0 ||
+            e.premiere + e.nombre > (mon_tournoi.taille >> e.tour))
+        {
+            return -1;
+        }
+        if (lire_tout(fd, mon_tournoi.tour[e.tour] + e.premiere, e.nombre * sizeof(Equipe)) != 0 ||
+            lire_tout(fd, mon_tournoi.resultats + id_match(e.tour - 1, e.premiere), e.nombre * sizeof(resultat_match)) != 0)
+        {
+            return -1;
+        }
+
+        // Tours reçus dans l'ordre : chaque qualifié finit au dernier tour atteint
+        for (int k = e.premiere; k < e.premiere + e.nombre; k++)
+        {
+            Equipe q = mon_tournoi.tour[e.tour][k];
+            if (q >= 0 && q < team_count)
+            {
+                mon_tournoi.parcours[q].tour_atteint = e.tour;
+            }
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief Joue les premiers tours de mon_tournoi (equipes placées au tour 0)
+ * dans des processus fils : l'arbre est coupé en nbr_processus sous arbres
+ * (arrondi à une puissance de 2, au plus taille / 2), chacun joué par un fils
+ * avec nbr_workers workers. Les qualifiés de chaque tour reviennent par une
+ * socket UNIX et remplissent mon_tournoi comme en mode local ; les résultats
+ * ne dépendent pas du découpage (un flux aléatoire par match).
+ *
+ * @param nbr_processus nombre de processus fils demandé
+ * @param nbr_workers workers de chaque fils (0 = un par coeur)
+ * @param niveau niveau du journal des fils
+ * @param transfert niveau maximal des evenements des fils à renvoyer au
+ * coordinateur (fichiers, sauvegarde, archive), -1 pour aucun
+ * @param ev reçoit ces evenements, à passer à journal_importer
+ * @return int le tour où le coordinateur reprend le tournoi (simuler_tours)
+ */
+int simuler_sous_tournois(int nbr_processus, int nbr_workers, int niveau, int transfert, evenements_fils *ev)
+{
+    nbr_processus = nearest_power_two(nbr_processus);
+    if (nbr_processus > mon_tournoi.taille / 2)
+    {
+        nbr_processus = mon_tournoi.taille / 2;
+    }
+    int tour_fin = nbr_tours;
+    while ((1 << (nbr_tours - tour_fin)) < nbr_processus)
+    {
+        tour_fin--;
+    }
+
+    int *sockets = malloc(nbr_processus * sizeof(int));
+    pid_t *fils = malloc(nbr_processus * sizeof(pid_t));
+    if (sockets == NULL || fils == NULL)
+    {
+        perror("Erreur allocation memoire");
+        exit(EXIT_FAILURE);
+    }
+
+    fflush(stdout);     // sinon le tampon serait recopié dans chaque fils
+    for (int i = 0; i < nbr_processus; i++)
+    {
+        int paire[2];
+        if (socketpair(AF_UNIX, SOCK_STREAM, 0, paire) != 0)
+        {
+            perror("Erreur creation socket");
+            exit(EXIT_FAILURE);
+        }
+        fils[i] = fork();
+        if (fils[i] < 0)
+        {
+            perror("Erreur lors de creation processus");
+            exit(EXIT_FAILURE);
+        }
+        if (fils[i] == 0)
+        {
+            close(paire[0]);
+            for (int j = 0; j < i; j++)
+            {
+                close(sockets[j]);
+            }
+            processus_fils(paire[1], i, nbr_processus, tour_fin, nbr_workers, niveau, transfert);
+        }
+        close(paire[1]);
+        sockets[i] = paire[0];
+    }
+
+    int erreur = 0;
+    ev->tab = NULL;
+    ev->nbr = 0;
+    for (int i = 0; i < nbr_processus; i++)
+    {
+        if (recevoir(sockets[i], tour_fin) != 0 || (transfert >= 0 && recevoir_evenements(sockets[i], ev) != 0))
+        {
+            fprintf(stderr, "Processus %d : qualifiés incomplets\n", i);
+            erreur = 1;
+        }
+        close(sockets[i]);
+    }
+    for (int i = 0; i < nbr_processus; i++)
+    {
+        int statut;
+        if (waitpid(fils[i], &statut, 0) < 0 || !WIFEXITED(statut) || WEXITSTATUS(statut) != 0)
+        {
+            erreur = 1;
+        }
+    }
+    free(sockets);
+    free(fils);
+
+    if (erreur)
+    {
+        fprintf(stderr, "Erreur : un processus fils a échoué\n");
+        exit(EXIT_FAILURE);
+    }
+    return tour_fin;
+}
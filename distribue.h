@@ -0,0 +1,20 @@
+/* distribue.h */
+#ifndef DISTRIBUE_H
+#define DISTRIBUE_H
+
+#include "journal.h"
+
+/* Structures de données */
+
+// Evenements journalisés par les processus fils, pour le journal du coordinateur
+typedef struct {
+    evenement *tab;
+    long nbr;
+} evenements_fils;
+
+/* ============================ Prototypes ============================ */
+// Joue les premiers tours de mon_tournoi dans nbr_processus processus fils et
+// rapatrie leurs qualifiés et leurs evenements ; renvoie le tour à partir duquel le coordinateur reprend
+int simuler_sous_tournois(int nbr_processus, int nbr_workers, int niveau, int transfert, evenements_fils *ev);
+
+#endif
@@ -0,0 +1,489 @@
+/**
+ * @file equipes.c
+ * @author Ferhat BEZTOUT
+ * @brief Table contiguë des equipes et arène des noms
+ * @version 1.0
+ * @date 2023-04-02
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "equipes.h"
+#include "modele.h"
+#include "pool.h"
+
+
+/**
+ * @brief Crée une table d'equipes vide
+ *
+ * @param capacite nombre d'equipes prévu (la table grandit si besoin)
+ * @return table_equipes
+ */
+table_equipes nouvelle_table_equipes(int capacite)
+{
+    table_equipes t;
+    if (capacite < 16)
+    {
+        capacite = 16;
+    }
+    t.nbr = 0;
+    t.capacite = capacite;
+    t.tab = malloc(capacite * sizeof(struct equipe));
+    t.taille_noms = 0;
+    t.capacite_noms = (size_t)capacite * 8;
+    t.noms = malloc(t.capacite_noms);
+    t.taille_carte = 0;
+    t.notee = 0;
+    if (t.tab == NULL || t.noms == NULL)
+    {
+        perror("Erreur allocation memoire");
+        exit(EXIT_FAILURE);
+    }
+    return t;
+}
+
+/**
+ * @brief Ajoute une equipe en fin de table. Le nom est copié dans l'arène,
+ * la table et l'arène doublent quand elles sont pleines.
+ *
+ * @param t la table des equipes
+ * @param nom nom de l'equipe
+ * @param lg_nom longueur du nom
+ * @return Equipe l'indice de la nouvelle equipe
+ */
+Equipe ajouter_equipe(table_equipes *t, const char *nom, size_t lg_nom)
+{
+    if (t->taille_carte > 0)
+    {
+        // Arène projetée en lecture seule : on la recopie avant d'y ajouter un nom
+        char *noms = malloc(t->taille_noms + lg_nom);
+        if (noms == NULL)
+        {
+            perror("Erreur allocation memoire");
+            exit(EXIT_FAILURE);
+        }
+        memcpy(noms, t->noms, t->taille_noms);
+        munmap(t->noms, t->taille_carte);
+        t->noms = noms;
+        t->capacite_noms = t->taille_noms + lg_nom;
+        t->taille_carte = 0;
+    }
+    if (t->nbr == t->capacite)
+    {
+        t->capacite *= 2;
+        t->tab = realloc(t->tab, t->capacite * sizeof(struct equipe));
+        if (t->tab == NULL)
+        {
+            perror("Erreur allocation memoire");
+            exit(EXIT_FAILURE);
+        }
+    }
+    if (t->taille_noms + lg_nom > t->capacite_noms)
+    {
+        if (t->capacite_noms == 0)
+        {
+            t->capacite_noms = 64;
+        }
+        while (t->taille_noms + lg_nom > t->capacite_noms)
+        {
+            t->capacite_noms *= 2;
+        }
+        t->noms = realloc(t->noms, t->capacite_noms);
+        if (t->noms == NULL)
+        {
+            perror("Erreur allocation memoire");
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    memcpy(t->noms + t->taille_noms, nom, lg_nom);
+
+    Equipe e = t->nbr++;
+    t->tab[e].id = e + 1;
+    t->tab[e].lg_nom = (uint32_t)lg_nom;
+    t->tab[e].nom = t->taille_noms;
+    t->tab[e].note = MODELE_NOTE_DEFAUT;
+    t->taille_noms += lg_nom;
+    return e;
+}
+
+/**
+ * @brief Renvoie le nom d'une equipe (à afficher avec "%.*s")
+ *
+ * @param t la table des equipes
+ * @param e l'equipe
+ * @return const char*
+ */
+const char *nom_equipe(const table_equipes *t, Equipe e)
+{
+    return t->noms + t->tab[e].nom;
+}
+
+/**
+ * @brief Renvoie la longueur du nom d'une equipe
+ *
+ * @param t la table des equipes
+ * @param e l'equipe
+ * @return int
+ */
+int lg_nom_equipe(const table_equipes *t, Equipe e)
+{
+    return (int)t->tab[e].lg_nom;
+}
+
+/**
+ * @brief lit tout un flux (tube, terminal...) par gros blocs dans un tampon alloué
+ *
+ * @param fd le descripteur
+ * @param taille taille lue
+ * @return char* le tampon
+ */
+static char *lire_flux(int fd, size_t *taille)
+{
+    size_t capacite = 1 << 20;
+    char *tampon = malloc(capacite);
+    *taille = 0;
+    while (tampon != NULL)
+    {
+        if (*taille == capacite)
+        {
+            capacite *= 2;
+            tampon = realloc(tampon, capacite);
+            if (tampon == NULL)
+            {
+                break;
+            }
+        }
+        ssize_t lu = read(fd, tampon + *taille, capacite - *taille);
+        if (lu < 0)
+        {
+            perror("Erreur de lecture fichier");
+            exit(EXIT_FAILURE);
+        }
+        if (lu == 0)
+        {
+            return tampon;
+        }
+        *taille += (size_t)lu;
+    }
+    perror("Erreur allocation memoire");
+    exit(EXIT_FAILURE);
+}
+
+/**
+ * @brief cherche une note en fin de ligne ("nom,note") : le texte aprés la
+ * derniére virgule doit être un nombre (espaces autour permis)
+ *
+ * @param ligne la ligne
+ * @param lg sa longueur, réduite à celle du nom si une note est trouvée
+ * @param note reçoit la note (arrondie au point prés)
+ * @return int 1 si la ligne porte une note
+ */
+static int lire_note(const char *ligne, size_t *lg, int *note)
+{
+    const char *virgule = NULL;
+    for (size_t i = *lg; i > 0; i--)
+    {
+        if (ligne[i - 1] == ',')
+        {
+            virgule = ligne + i - 1;
+            break;
+        }
+    }
+    if (virgule == NULL || virgule == ligne)
+    {
+        return 0;
+    }
+    size_t lg_note = ligne + *lg - (virgule + 1);
+    if (lg_note == 0 || lg_note > 31)
+    {
+        return 0;
+    }
+
+    // Le texte projeté n'est pas terminé par '\0' : copie de la note seule
+    char texte[32], *fin;
+    memcpy(texte, virgule + 1, lg_note);
+    texte[lg_note] = '\0';
+    double valeur = strtod(texte, &fin);
+    while (*fin == ' ' || *fin == '\t')
+    {
+        fin++;
+    }
+    if (fin == texte || *fin != '\0')
+    {
+        return 0;
+    }
+    *note = (int)lrint(valeur);
+    *lg = virgule - ligne;
+    return 1;
+}
+
+/**
+ * @brief Charge les equipes d'un fichier texte (une par ligne). Le fichier est
+ * projeté en mémoire et sert d'arène : chaque nom est une tranche du fichier,
+ * sans copie ni limite de longueur. Les lignes vides sont ignorées, un '\r' final
+ * est retiré. Une ligne "nom,note" donne sa note à l'equipe (MODELE_NOTE_DEFAUT
+ * sinon). Les fichiers non projetables (tubes) sont lus par gros blocs.
+ *
+ * @param filename le chemin du fichier texte (une equipe par ligne)
+ * @param t la table des equipes (vide)
+ */
+void read_teams(char *filename, table_equipes *t)
+{
+    int fd = open(filename, O_RDONLY);
+    if (fd == -1)
+    {
+        perror("Erreur d'ouverture fichier");
+        exit(EXIT_FAILURE);
+    }
+
+    struct stat st;
+    char *texte = NULL;
+    size_t taille = 0;
+    if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0)
+    {
+        taille = (size_t)st.st_size;
+        texte = mmap(NULL, taille, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (texte == MAP_FAILED)
+        {
+            texte = NULL;
+        }
+        else
+        {
+            madvise(texte, taille, MADV_SEQUENTIAL);
+            t->taille_carte = taille;
+        }
+    }
+    if (texte == NULL)
+    {
+        texte = lire_flux(fd, &taille);
+    }
+    close(fd);
+
+    // Premier passage : compter les lignes pour dimensionner la table d'un coup
+    size_t nbr_lignes = 0;
+    for (const char *p = texte, *fin = texte + taille; p < fin; nbr_lignes++)
+    {
+        const char *nl = memchr(p, '\n', fin - p);
+        p = (nl == NULL) ? fin : nl + 1;
+    }
+    if (nbr_lignes > (size_t)t->capacite)
+    {
+        t->capacite = (int)nbr_lignes;
+        t->tab = realloc(t->tab, t->capacite * sizeof(struct equipe));
+        if (t->tab == NULL)
+        {
+            perror("Erreur allocation memoire");
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    // L'arène allouée par nouvelle_table_equipes est remplacée par le texte
+    free(t->noms);
+    t->noms = texte;
+    t->taille_noms = taille;
+    t->capacite_noms = taille;
+
+    // Second passage : une tranche du texte par equipe
+    const char *fin = texte + taille;
+    for (const char *p = texte; p < fin;)
+    {
+        const char *nl = memchr(p, '\n', fin - p);
+        const char *fin_ligne = (nl == NULL) ? fin : nl;
+        size_t lg = fin_ligne - p;
+        if (lg > 0 && p[lg - 1] == '\r')
+        {
+            lg--;
+        }
+        int note = MODELE_NOTE_DEFAUT;
+        if (lg > 0 && lire_note(p, &lg, &note))
+        {
+            t->notee = 1;
+        }
+        if (lg > 0)
+        {
+            Equipe e = t->nbr++;
+            t->tab[e].id = e + 1;
+            t->tab[e].lg_nom = (uint32_t)lg;
+            t->tab[e].nom = (size_t)(p - texte);
+            t->tab[e].note = note;
+        }
+        p = fin_ligne + 1;
+    }
+}
+
+/**
+ * @brief Garder le nombre d'equipe comme une puissance de 2 (on supprime les equipes excedentes)
+ *
+ * @param t la table des equipes
+ */
+void keep_power_of_two(table_equipes *t)
+{
+    if (t->nbr == 0)
+    {
+        return;
+    }
+
+    int size = 1;
+    while (size * 2 <= t->nbr)
+    {
+        size *= 2;
+    }
+
+    // Les equipes excedentes sont en fin de table : il suffit de la tronquer
+    t->nbr = size;
+}
+
+/* Tranche d'equipes générée par une tache du pool */
+typedef struct {
+    table_equipes *t;
+    const char *prefixe;
+    size_t lg_prefixe;
+    int largeur;            // lettres par nom
+    Equipe debut;
+    Equipe fin;
+} lot_noms;
+
+/**
+ * @brief Tache du pool : écrit les equipes [debut, fin[ directement dans la
+ * table et l'arène des noms. Le nom de l'equipe i est le préfixe suivi de i en
+ * base 26 (A à Z) sur largeur lettres : le premier est calculé, les suivants
+ * s'obtiennent en ajoutant 1 avec retenue.
+ *
+ * @param arg le lot
+ */
+static void generer_lot(void *arg)
+{
+    lot_noms *l = (lot_noms *)arg;
+    table_equipes *t = l->t;
+    size_t lg = l->lg_prefixe + l->largeur;
+    if (l->debut >= l->fin)
+    {
+        return;
+    }
+
+    char *nom = t->noms + (size_t)l->debut * lg;
+    memcpy(nom, l->prefixe, l->lg_prefixe);
+    for (int k = l->largeur - 1, v = l->debut; k >= 0; k--, v /= 26)
+    {
+        nom[l->lg_prefixe + k] = 'A' + v % 26;
+    }
+    for (Equipe e = l->debut; e < l->fin; e++)
+    {
+        if (e > l->debut)
+        {
+            char *precedent = nom;
+            nom += lg;
+            memcpy(nom, precedent, lg);
+            int k = (int)lg - 1;
+            while (nom[k] == 'Z')
+            {
+                nom[k--] = 'A';
+            }
+            nom[k]++;
+        }
+        t->tab[e].id = e + 1;
+        t->tab[e].lg_nom = (uint32_t)lg;
+        t->tab[e].nom = (size_t)e * lg;
+        t->tab[e].note = MODELE_NOTE_DEFAUT;
+    }
+}
+
+/**
+ * @brief Génére nbr equipes synthétiques dans une table vide, en parallèle sur
+ * le pool : chaque worker remplit sa tranche de la table et de l'arène (aucun
+ * partage, les pages sont touchées par le thread qui les écrit). Les noms ont
+ * tous la même longueur (préfixe puis au moins 3 lettres), sont uniques et ne
+ * dépendent que de l'indice : AAA, AAB, ... AAZ, ABA...
+ *
+ * @param t la table des equipes (vide)
+ * @param nbr nombre d'equipes
+ * @param prefixe préfixe des noms ("" pour aucun)
+ * @param p le pool de workers
+ */
+void generer_equipes(table_equipes *t, int nbr, const char *prefixe, pool *p)
+{
+    int largeur = 3;
+    for (long capacite = 26 * 26 * 26; capacite < nbr; capacite *= 26)
+    {
+        largeur++;
+    }
+    size_t lg_prefixe = strlen(prefixe);
+    size_t lg = lg_prefixe + largeur;
+
+    // Pas de realloc : le contenu (vide) n'a pas à être recopié
+    free(t->tab);
+    free(t->noms);
+    t->capacite = (nbr > 0) ? nbr : 1;
+    t->tab = malloc(t->capacite * sizeof(struct equipe));
+    t->capacite_noms = (size_t)t->capacite * lg;
+    t->noms = malloc(t->capacite_noms);
+    if (t->tab == NULL || t->noms == NULL)
+    {
+        perror("Erreur allocation memoire");
+        exit(EXIT_FAILURE);
+    }
+    t->taille_carte = 0;
+
+    int nbr_lots = p->nbr_workers;
+    lot_noms *lots = malloc(nbr_lots * sizeof(lot_noms));
+    if (lots == NULL)
+    {
+        perror("Erreur allocation memoire");
+        exit(EXIT_FAILURE);
+    }
+    for (int i = 0; i < nbr_lots; i++)
+    {
+        lots[i] = (lot_noms){t, prefixe, lg_prefixe, largeur,
+                             (Equipe)((long)nbr * i / nbr_lots), (Equipe)((long)nbr * (i + 1) / nbr_lots)};
+        pool_soumettre(p, generer_lot, &lots[i]);
+    }
+    pool_attendre(p);
+    free(lots);
+
+    t->nbr = nbr;
+    t->taille_noms = (size_t)nbr * lg;
+}
+
+/**
+ * @brief Fonction pour afficher la table des équipes
+ *
+ * @param t la table des equipes
+ */
+void afficher_equipes(const table_equipes *t)
+{
+    for (Equipe e = 0; e < t->nbr; e++)
+    {
+        printf("\tid:%d, nom: %.*s\n", t->tab[e].id, lg_nom_equipe(t, e), nom_equipe(t, e));
+    }
+}
+
+/**
+ * @brief Libére la table et l'arène des noms
+ *
+ * @param t la table des equipes
+ */
+void liberer_table_equipes(table_equipes *t)
+{
+    free(t->tab);
+    if (t->taille_carte > 0)
+    {
+        munmap(t->noms, t->taille_carte);
+    }
+    else
+    {
+        free(t->noms);
+    }
+    t->tab = NULL;
+    t->noms = NULL;
+    t->nbr = 0;
+}
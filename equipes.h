@@ -0,0 +1,66 @@
+/* equipes.h */
+#ifndef EQUIPES_H
+#define EQUIPES_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "alea.h"
+#include "pool.h"
+
+/* Structures de données */
+
+// Une equipe est désignée par son indice dans la table des equipes
+typedef int Equipe;
+
+struct equipe {
+    int id;
+    uint32_t lg_nom;    // longueur du nom
+    size_t nom;         // position du nom dans l'arène des noms
+    int note;           // force de l'equipe (points Elo, voir modele.h)
+};
+
+// Table contiguë des equipes, les noms sont rangés bout à bout dans une seule arène.
+// Quand la table vient d'un fichier projeté en mémoire, l'arène est le fichier lui même.
+typedef struct {
+    struct equipe *tab;
+    int nbr;
+    int capacite;
+
+    char *noms;
+    size_t taille_noms;
+    size_t capacite_noms;
+    size_t taille_carte;    // taille de la projection (0 si l'arène est allouée)
+    int notee;              // 1 si au moins une equipe a une note donnée
+} table_equipes;
+
+
+/* ============================ Prototypes ============================ */
+// Crée une table d'equipes vide
+table_equipes nouvelle_table_equipes(int capacite);
+
+// Ajoute une equipe en fin de table (temps constant amorti)
+Equipe ajouter_equipe(table_equipes *t, const char *nom, size_t lg_nom);
+
+// Renvoie le nom d'une equipe (non terminé par '\0', voir lg_nom_equipe)
+const char *nom_equipe(const table_equipes *t, Equipe e);
+
+// Renvoie la longueur du nom d'une equipe
+int lg_nom_equipe(const table_equipes *t, Equipe e);
+
+// Charge les équipes d'un fichier texte (une par ligne, "nom" ou "nom,note") sans copier les noms
+void read_teams(char *filename, table_equipes *t);
+
+// Garde le nombre d'equipe comme une puissance de 2 (on supprime les equipes excedentes)
+void keep_power_of_two(table_equipes *t);
+
+// Génére nbr equipes aux noms uniques (préfixe + base 26) en parallèle sur le pool
+void generer_equipes(table_equipes *t, int nbr, const char *prefixe, pool *p);
+
+// Affiche la table des equipes
+void afficher_equipes(const table_equipes *t);
+
+// Libére la table et l'arène des noms
+void liberer_table_equipes(table_equipes *t);
+
+#endif
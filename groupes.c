@@ -0,0 +1,307 @@
+/**
+ * @file groupes.c
+ * @author Ferhat BEZTOUT
+ * @brief Phase de groupes : chaque groupe joue tous ses matchs (aller simple),
+ * en parallèle, les premiers de chaque groupe passent au tableau final
+ * @version 1.0
+ * @date 2023-04-02
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "main.h"
+#include "groupes.h"
+#include "modele.h"
+#include "alea.h"
+
+/* Un match de groupe */
+typedef struct {
+    int groupe;
+    Equipe e1;
+    Equipe e2;
+} rencontre;
+
+/* Un lot de matchs joués par une tache du pool, avec son propre classement */
+typedef struct {
+    const table_equipes *equipes;
+    const rencontre *rencontres;
+    long premier;               // premier match du lot (c'est aussi son flux aléatoire)
+    long nbr;
+    uint64_t graine;
+    Equipe premiere_equipe;     // le classement du lot couvre [premiere_equipe, premiere_equipe + nbr_lignes[
+    int nbr_lignes;
+    ligne_classement *classement;
+} lot_groupes;
+
+// Groupe en cours de tri (qsort n'a pas de paramétre utilisateur)
+static const ligne_classement *classement_tri;
+
+
+/**
+ * @brief joue un match de groupe sans journal ni attente : DUREE_MATCH actions,
+ * 1 chance sur 5 de but, le côté qui marque suivant les notes (modele.h).
+ * Le nul est possible.
+ *
+ * @param t la table des equipes
+ * @param e1 premiére equipe
+ * @param e2 seconde equipe
+ * @param graine graine maître
+ * @param flux flux aléatoire du match
+ * @param score_e1 reçoit le score de e1
+ * @param score_e2 reçoit le score de e2
+ */
+static void jouer_rencontre(const table_equipes *t, Equipe e1, Equipe e2, uint64_t graine, uint64_t flux,
+                            int *score_e1, int *score_e2)
+{
+    uint32_t seuil = modele_seuil(t, e1, e2);
+    alea a;
+    alea_init(&a, graine, flux);
+    *score_e1 = 0;
+    *score_e2 = 0;
+    for (int temps = 0; temps < DUREE_MATCH; temps++)
+    {
+        if (alea_borne(&a, 5) == 0)
+        {
+            if ((uint32_t)(alea_suivant(&a) >> 32) < seuil)
+            {
+                (*score_e1)++;
+            }
+            else
+            {
+                (*score_e2)++;
+            }
+        }
+    }
+}
+
+/**
+ * @brief ajoute le résultat d'un match à une ligne de classement
+ */
+static void compter(ligne_classement *l, int pour, int contre)
+{
+    l->joues++;
+    l->buts_pour += pour;
+    l->buts_contre += contre;
+    l->points += (pour > contre) ? 3 : (pour == contre);
+}
+
+/**
+ * @brief Tache du pool : joue les matchs d'un lot dans son classement privé
+ * (aucun verrou, aucune écriture partagée)
+ *
+ * @param arg le lot
+ */
+static void jouer_lot_groupes(void *arg)
+{
+    lot_groupes *l = (lot_groupes *)arg;
+    for (long i = l->premier; i < l->premier + l->nbr; i++)
+    {
+        const rencontre *r = &l->rencontres[i];
+        int s1, s2;
+        jouer_rencontre(l->equipes, r->e1, r->e2, l->graine, GROUPES_FLUX + (uint64_t)i, &s1, &s2);
+        compter(&l->classement[r->e1 - l->premiere_equipe], s1, s2);
+        compter(&l->classement[r->e2 - l->premiere_equipe], s2, s1);
+    }
+}
+
+/**
+ * @brief ordre du classement : points, différence de buts, buts marqués, puis
+ * ordre de la table
+ */
+static int comparer_lignes(const void *a, const void *b)
+{
+    Equipe ea = *(const Equipe *)a, eb = *(const Equipe *)b;
+    const ligne_classement *la = &classement_tri[ea], *lb = &classement_tri[eb];
+    if (la->points != lb->points)
+    {
+        return lb->points - la->points;
+    }
+    int da = la->buts_pour - la->buts_contre, db = lb->buts_pour - lb->buts_contre;
+    if (da != db)
+    {
+        return db - da;
+    }
+    if (la->buts_pour != lb->buts_pour)
+    {
+        return lb->buts_pour - la->buts_pour;
+    }
+    return ea - eb;
+}
+
+/**
+ * @brief Joue la phase de groupes. Les equipes sont réparties dans l'ordre de
+ * la table en groupes de taille_groupe (le dernier peut être plus petit). Tous
+ * les matchs sont construits d'avance puis découpés en un lot par worker ;
+ * chaque lot tient le classement des seules equipes de ses groupes, et les
+ * classements sont additionnés aprés pool_attendre. Le match i utilise le
+ * flux (graine, GROUPES_FLUX + i) : le résultat ne dépend pas du nombre de workers.
+ *
+ * Les qualifiés sont rangés groupe par groupe pour start_tournoi : premier du
+ * groupe g, deuxiéme du groupe g+1, troisiéme du groupe g+2... si bien qu'au
+ * premier tour un premier de groupe rencontre le deuxiéme d'un autre groupe.
+ *
+ * @param p le pool de workers
+ * @param t la table des equipes
+ * @param taille_groupe nombre d'equipes par groupe (au moins 2)
+ * @param nbr_qualifies nombre de qualifiés par groupe
+ * @param graine graine maître
+ * @param afficher 1 pour afficher le classement de chaque groupe
+ * @return table_equipes les qualifiés (noms et notes copiés, id d'origine gardé)
+ */
+table_equipes phase_de_groupes(pool *p, const table_equipes *t, int taille_groupe, int nbr_qualifies,
+                               uint64_t graine, int afficher)
+{
+    int n = t->nbr;
+    int nbr_groupes = (n + taille_groupe - 1) / taille_groupe;
+
+    // Tous les matchs, groupe par groupe
+    long nbr_rencontres = 0;
+    for (int g = 0; g < nbr_groupes; g++)
+    {
+        long k = (g == nbr_groupes - 1) ? n - (long)g * taille_groupe : taille_groupe;
+        nbr_rencontres += k * (k - 1) / 2;
+    }
+    rencontre *rencontres = malloc((nbr_rencontres + 1) * sizeof(rencontre));
+    ligne_classement *classement = calloc(n, sizeof(ligne_classement));
+    if (rencontres == NULL || classement == NULL)
+    {
+        perror("Erreur allocation memoire");
+        exit(EXIT_FAILURE);
+    }
+    long r = 0;
+    for (int g = 0; g < nbr_groupes; g++)
+    {
+        Equipe debut = g * taille_groupe;
+        Equipe fin = (debut + taille_groupe < n) ? debut + taille_groupe : n;
+        for (Equipe e1 = debut; e1 < fin; e1++)
+        {
+            for (Equipe e2 = e1 + 1; e2 < fin; e2++)
+            {
+                rencontres[r++] = (rencontre){g, e1, e2};
+            }
+        }
+    }
+
+    struct timespec t_debut, t_fin;
+    clock_gettime(CLOCK_MONOTONIC, &t_debut);
+
+    int nbr_lots = p->nbr_workers;
+    if (nbr_lots > nbr_rencontres)
+    {
+        nbr_lots = (nbr_rencontres > 0) ? (int)nbr_rencontres : 1;
+    }
+    lot_groupes *lots = malloc(nbr_lots * sizeof(lot_groupes));
+    if (lots == NULL)
+    {
+        perror("Erreur allocation memoire");
+        exit(EXIT_FAILURE);
+    }
+    long premier = 0;
+    for (int i = 0; i < nbr_lots; i++)
+    {
+        lot_groupes *l = &lots[i];
+        l->equipes = t;
+        l->rencontres = rencontres;
+        l->premier = premier;
+        l->nbr = nbr_rencontres / nbr_lots + (i < nbr_rencontres % nbr_lots);
+        l->graine = graine;
+        l->premiere_equipe = 0;
+        l->nbr_lignes = 0;
+        if (l->nbr > 0)
+        {
+            // Les groupes du lot se suivent : leurs equipes aussi
+            int g_debut = rencontres[premier].groupe, g_fin = rencontres[premier + l->nbr - 1].groupe;
+            l->premiere_equipe = g_debut * taille_groupe;
+            int derniere = ((g_fin + 1) * taille_groupe < n) ? (g_fin + 1) * taille_groupe : n;
+            l->nbr_lignes = derniere - l->premiere_equipe;
+        }
+        l->classement = calloc(l->nbr_lignes + 1, sizeof(ligne_classement));
+        if (l->classement == NULL)
+        {
+            perror("Erreur allocation memoire");
+            exit(EXIT_FAILURE);
+        }
+        premier += l->nbr;
+        pool_soumettre(p, jouer_lot_groupes, l);
+    }
+    pool_attendre(p);
+
+    // Fusion : seuls les groupes à cheval sur deux lots sont additionnés
+    for (int i = 0; i < nbr_lots; i++)
+    {
+        for (int k = 0; k < lots[i].nbr_lignes; k++)
+        {
+            ligne_classement *dst = &classement[lots[i].premiere_equipe + k], *src = &lots[i].classement[k];
+            dst->points += src->points;
+            dst->buts_pour += src->buts_pour;
+            dst->buts_contre += src->buts_contre;
+            dst->joues += src->joues;
+        }
+        free(lots[i].classement);
+    }
+    free(lots);
+    free(rencontres);
+    clock_gettime(CLOCK_MONOTONIC, &t_fin);
+
+    // Classement de chaque groupe puis qualifiés
+    Equipe *ordre = malloc(n * sizeof(Equipe));
+    if (ordre == NULL)
+    {
+        perror("Erreur allocation memoire");
+        exit(EXIT_FAILURE);
+    }
+    classement_tri = classement;
+    for (int g = 0; g < nbr_groupes; g++)
+    {
+        Equipe debut = g * taille_groupe;
+        int k = (debut + taille_groupe < n) ? taille_groupe : n - debut;
+        for (int i = 0; i < k; i++)
+        {
+            ordre[debut + i] = debut + i;
+        }
+        qsort(ordre + debut, k, sizeof(Equipe), comparer_lignes);
+        if (afficher)
+        {
+            printf("-Groupe %d :\n", g + 1);
+            for (int i = 0; i < k; i++)
+            {
+                Equipe e = ordre[debut + i];
+                const ligne_classement *l = &classement[e];
+                printf("\t%d. %.*s  %d pts (%d j, %d-%d)\n", i + 1, lg_nom_equipe(t, e), nom_equipe(t, e),
+                       l->points, l->joues, l->buts_pour, l->buts_contre);
+            }
+        }
+    }
+
+    table_equipes q = nouvelle_table_equipes(nbr_groupes * nbr_qualifies);
+    for (int g = 0; g < nbr_groupes; g++)
+    {
+        for (int rang = 0; rang < nbr_qualifies; rang++)
+        {
+            int gq = (g + rang) % nbr_groupes;
+            Equipe debut = gq * taille_groupe;
+            int k = (debut + taille_groupe < n) ? taille_groupe : n - debut;
+            if (rang >= k)
+            {
+                continue;
+            }
+            Equipe e = ordre[debut + rang];
+            Equipe eq = ajouter_equipe(&q, nom_equipe(t, e), lg_nom_equipe(t, e));
+            q.tab[eq].id = t->tab[e].id;
+            q.tab[eq].note = t->tab[e].note;
+        }
+    }
+    q.notee = t->notee;
+
+    double duree = (t_fin.tv_sec - t_debut.tv_sec) + (t_fin.tv_nsec - t_debut.tv_nsec) / 1e9;
+    fprintf(afficher ? stdout : stderr, "Phase de groupes : %d groupes, %ld matchs en %.3f s, %d qualifiés\n",
+            nbr_groupes, nbr_rencontres, duree, q.nbr);
+    free(ordre);
+    free(classement);
+    return q;
+}
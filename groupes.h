@@ -0,0 +1,30 @@
+/* groupes.h */
+#ifndef GROUPES_H
+#define GROUPES_H
+
+#include <stdint.h>
+
+#include "equipes.h"
+#include "pool.h"
+
+/* Définitions des constantes */
+#define GROUPES_FLUX (1ULL << 40)   // premier flux aléatoire des matchs de groupe (après ceux du tableau)
+
+/* Structures de données */
+
+// Ligne du classement d'une equipe dans son groupe
+typedef struct {
+    int points;         // 3 par victoire, 1 par nul
+    int buts_pour;
+    int buts_contre;
+    int joues;
+} ligne_classement;
+
+
+/* ============================ Prototypes ============================ */
+// Joue tous les matchs des groupes en parallèle et renvoie la table des qualifiés,
+// rangés pour start_tournoi
+table_equipes phase_de_groupes(pool *p, const table_equipes *t, int taille_groupe, int nbr_qualifies,
+                               uint64_t graine, int afficher);
+
+#endif
@@ -0,0 +1,487 @@
+/**
+ * @file journal.c
+ * @author Ferhat BEZTOUT
+ * @brief Journal des evenements de match : un anneau par thread, vidé par un
+ * thread écrivain en arriére plan
+ * @version 1.0
+ * @date 2023-04-02
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <time.h>
+#include <unistd.h>
+#include <sched.h>
+
+#include "journal.h"
+#include "archive.h"
+
+/* Anneau mono-producteur / mono-consommateur d'un thread */
+typedef struct anneau {
+    evenement ev[JOURNAL_TAILLE_ANNEAU];
+    atomic_uint_fast64_t ecrit;     // avancé par le thread producteur
+    atomic_uint_fast64_t lu;        // avancé par le thread écrivain
+    struct anneau *suivant;
+} anneau;
+
+static _Atomic(anneau *) anneaux = NULL;
+static _Thread_local anneau *mon_anneau = NULL;
+static atomic_uint generation;                  // avancée par journal_fermer, qui libére les anneaux
+static _Thread_local unsigned ma_generation;    // génération de mon_anneau
+
+static const table_equipes *equipes_journal;
+static int niveau_journal = JOURNAL_DETAIL;     // affichage
+static int niveau_fichiers = JOURNAL_RESULTAT;  // jsonl et binaire
+static int couleur;
+static FILE *sortie_jsonl;
+static FILE *sortie_bin;
+static FILE *sortie_reprise;    // resultats des matchs, fsync périodique
+static uint64_t dernier_fsync;
+static archive *sortie_archive; // resultats des matchs, en colonnes
+
+static pthread_t ecrivain;
+static atomic_int arret;
+static int ouvert = 0;
+
+
+/**
+ * @brief date courante de l'horloge monotone en nanosecondes
+ *
+ * @return uint64_t
+ */
+static uint64_t maintenant_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+/**
+ * @brief crée l'anneau du thread appelant et l'ajoute (sans verrou) à la liste
+ *
+ * @return anneau*
+ */
+static anneau *nouvel_anneau(void)
+{
+    anneau *a = malloc(sizeof(anneau));
+    if (a == NULL)
+    {
+        perror("Erreur allocation memoire");
+        exit(EXIT_FAILURE);
+    }
+    atomic_init(&a->ecrit, 0);
+    atomic_init(&a->lu, 0);
+    a->suivant = atomic_load(&anneaux);
+    while (!atomic_compare_exchange_weak(&anneaux, &a->suivant, a))
+    {
+    }
+    return a;
+}
+
+/**
+ * @brief affiche un evenement en texte (couleurs seulement sur un terminal)
+ *
+ * @param ev l'evenement
+ */
+static void ecrire_texte(const evenement *ev)
+{
+    const char *jaune = couleur ? "\033[0;33m" : "";
+    const char *vert = couleur ? "\033[0;32m" : "";
+    const char *fin = couleur ? "\033[0m" : "";
+    const table_equipes *t = equipes_journal;
+    int l1 = lg_nom_equipe(t, ev->e1), l2 = lg_nom_equipe(t, ev->e2), l = lg_nom_equipe(t, ev->equipe);
+    const char *n1 = nom_equipe(t, ev->e1), *n2 = nom_equipe(t, ev->e2), *n = nom_equipe(t, ev->equipe);
+
+    switch (ev->type)
+    {
+    case EV_COUP_ENVOI:
+        printf("%s[Tour %d]%s Coup d'envoi entre %.*s et %.*s\n", jaune, ev->tour, fin, l1, n1, l2, n2);
+        break;
+    case EV_BUT:
+        printf("%s[Tour %d]%s %.*s a marqué !\n\t %.*s %d - %d %.*s\n", jaune, ev->tour, fin, l, n, l1, n1, ev->score_e1, ev->score_e2, l2, n2);
+        break;
+    case EV_SCORE_FINAL:
+        printf("%s[Tour %d]%s Score final : %.*s %d - %d %.*s\n", jaune, ev->tour, fin, l1, n1, ev->score_e1, ev->score_e2, l2, n2);
+        break;
+    case EV_GAGNANT:
+        printf("%s[Tour %d] %s%sEquipe gagnante : %.*s%s\n", jaune, ev->tour, fin, vert, l, n, fin);
+        break;
+    case EV_PENALTIES:
+        printf("%s[Tour %d]%s %sScore nul, l'equipe %.*s gagne grâce aux penalties%s\n", jaune, ev->tour, fin, vert, l, n, fin);
+        break;
+    case EV_VAINQUEUR:
+        printf("%sVainqueur du tournoi : %.*s%s\n", vert, l, n, fin);
+        break;
+    case EV_EXEMPT:
+        printf("%s[Tour %d]%s %.*s est exempté et passe au tour suivant\n", jaune, ev->tour, fin, l, n);
+        break;
+    }
+}
+
+/**
+ * @brief écrit un nom en chaîne JSON (guillemets et antislash échappés)
+ *
+ * @param f le fichier
+ * @param nom le nom
+ * @param lg sa longueur
+ */
+static void ecrire_nom_json(FILE *f, const char *nom, int lg)
+{
+    fputc('"', f);
+    for (int i = 0; i < lg; i++)
+    {
+        unsigned char c = (unsigned char)nom[i];
+        if (c == '"' || c == '\\')
+        {
+            fputc('\\', f);
+            fputc(c, f);
+        }
+        else if (c < 0x20)
+        {
+            fprintf(f, "\\u%04x", c);
+        }
+        else
+        {
+            fputc(c, f);
+        }
+    }
+    fputc('"', f);
+}
+
+/**
+ * @brief écrit un evenement sur une ligne JSON
+ *
+ * @param ev l'evenement
+ */
+static void ecrire_jsonl(const evenement *ev)
+{
+    static const char *types[] = {"coup_envoi", "but", "score_final", "gagnant", "penalties", "vainqueur", "exempt"};
+    const table_equipes *t = equipes_journal;
+
+    fprintf(sortie_jsonl, "{\"t_ns\":%llu,\"type\":\"%s\",\"tour\":%d,\"match\":%d,\"e1\":",
+            (unsigned long long)ev->t_ns, types[ev->type], ev->tour, ev->num_match);
+    ecrire_nom_json(sortie_jsonl, nom_equipe(t, ev->e1), lg_nom_equipe(t, ev->e1));
+    fputs(",\"e2\":", sortie_jsonl);
+    ecrire_nom_json(sortie_jsonl, nom_equipe(t, ev->e2), lg_nom_equipe(t, ev->e2));
+    fputs(",\"equipe\":", sortie_jsonl);
+    ecrire_nom_json(sortie_jsonl, nom_equipe(t, ev->equipe), lg_nom_equipe(t, ev->equipe));
+    fprintf(sortie_jsonl, ",\"score\":[%d,%d]}\n", ev->score_e1, ev->score_e2);
+}
+
+/**
+ * @brief vide tous les anneaux vers les sorties
+ *
+ * @return int nombre d'evenements écrits
+ */
+static int vider_anneaux(void)
+{
+    int total = 0;
+    for (anneau *a = atomic_load(&anneaux); a != NULL; a = a->suivant)
+    {
+        uint_fast64_t lu = atomic_load_explicit(&a->lu, memory_order_relaxed);
+        uint_fast64_t ecrit = atomic_load_explicit(&a->ecrit, memory_order_acquire);
+        for (; lu < ecrit; lu++)
+        {
+            const evenement *ev = &a->ev[lu & (JOURNAL_TAILLE_ANNEAU - 1)];
+            evenement copie;
+            int afficher = (ev->niveau <= niveau_journal);
+            if (ev->reserve & JOURNAL_IMPORTE)
+            {
+                // Déjà affiché par le processus fils ; le drapeau ne va pas dans les fichiers
+                copie = *ev;
+                copie.reserve = 0;
+                ev = &copie;
+                afficher = 0;
+            }
+            if (ev->type == EV_GAGNANT || ev->type == EV_PENALTIES)
+            {
+                if (sortie_reprise != NULL)
+                {
+                    fwrite(ev, sizeof(evenement), 1, sortie_reprise);
+                }
+                if (sortie_archive != NULL)
+                {
+                    archive_ajouter(sortie_archive, ev);
+                }
+            }
+            total++;
+            if (afficher)
+            {
+                ecrire_texte(ev);
+            }
+            if (ev->niveau > niveau_fichiers)
+            {
+                continue;
+            }
+            if (sortie_jsonl != NULL)
+            {
+                ecrire_jsonl(ev);
+            }
+            if (sortie_bin != NULL)
+            {
+                fwrite(ev, sizeof(evenement), 1, sortie_bin);
+            }
+        }
+        atomic_store_explicit(&a->lu, lu, memory_order_release);
+    }
+    return total;
+}
+
+/**
+ * @brief met la sauvegarde sur disque, au plus une fois par JOURNAL_PERIODE_FSYNC
+ * (sauf si force) : le fsync reste dans le thread écrivain, hors des workers
+ *
+ * @param force fsync même si la période n'est pas écoulée
+ */
+static void synchroniser_reprise(int force)
+{
+    if (sortie_reprise == NULL)
+    {
+        return;
+    }
+    uint64_t t = maintenant_ns();
+    if (force || t - dernier_fsync >= JOURNAL_PERIODE_FSYNC)
+    {
+        fflush(sortie_reprise);
+        fsync(fileno(sortie_reprise));
+        dernier_fsync = t;
+    }
+}
+
+/**
+ * @brief boucle du thread écrivain
+ *
+ * @param arg inutilisé
+ * @return void*
+ */
+static void *thread_ecrivain(void *arg)
+{
+    (void)arg;
+    while (!atomic_load(&arret))
+    {
+        if (vider_anneaux() == 0)
+        {
+            fflush(stdout);
+            usleep(1000);
+        }
+        synchroniser_reprise(0);
+    }
+    vider_anneaux();
+    synchroniser_reprise(1);
+    return NULL;
+}
+
+/**
+ * @brief ouvre un fichier de sortie du journal
+ *
+ * @param chemin le chemin du fichier
+ * @return FILE*
+ */
+static FILE *ouvrir_sortie(const char *chemin)
+{
+    FILE *f = fopen(chemin, "wb");
+    if (f == NULL)
+    {
+        perror("Erreur d'ouverture fichier journal");
+        exit(EXIT_FAILURE);
+    }
+    setvbuf(f, NULL, _IOFBF, 1 << 20);
+    return f;
+}
+
+/**
+ * @brief Démarre le journal et son thread écrivain
+ *
+ * @param equipes la table des equipes (pour afficher les noms)
+ * @param niveau niveau maximal des evenements affichés
+ * @param fichiers niveau maximal des evenements écrits dans jsonl et bin
+ * @param jsonl fichier JSONL (NULL pour aucun)
+ * @param bin fichier binaire d'evenements (NULL pour aucun)
+ * @param reprise sauvegarde ouverte par reprise.c, qui reçoit le resultat de
+ * chaque match quel que soit le niveau (NULL pour aucune)
+ * @param arch archive créée par archive.c, qui reçoit elle aussi le resultat
+ * de chaque match ; le journal la ferme (NULL pour aucune)
+ */
+void journal_ouvrir(const table_equipes *equipes, int niveau, int fichiers, const char *jsonl, const char *bin,
+                    FILE *reprise, archive *arch)
+{
+    equipes_journal = equipes;
+    niveau_journal = niveau;
+    niveau_fichiers = fichiers;
+    couleur = isatty(STDOUT_FILENO);
+    sortie_jsonl = (jsonl != NULL) ? ouvrir_sortie(jsonl) : NULL;
+    sortie_bin = NULL;
+    if (bin != NULL)
+    {
+        // En-tête : signature, version, taille d'un enregistrement
+        uint32_t entete[3] = {0x4a4e5254 /* "TRNJ" */, 1, sizeof(evenement)};
+        sortie_bin = ouvrir_sortie(bin);
+        fwrite(entete, sizeof(entete), 1, sortie_bin);
+    }
+
+    sortie_reprise = reprise;
+    sortie_archive = arch;
+    dernier_fsync = maintenant_ns();
+
+    atomic_store(&arret, 0);
+    if (pthread_create(&ecrivain, NULL, thread_ecrivain, NULL) != 0)
+    {
+        perror("Erreur lors de creation thread journal");
+        exit(EXIT_FAILURE);
+    }
+    ouvert = 1;
+}
+
+/**
+ * @brief Renvoie 1 si un evenement de ce niveau sera gardé
+ *
+ * @param niveau niveau de l'evenement
+ * @return int
+ */
+int journal_actif(int niveau)
+{
+    return ouvert && (niveau <= niveau_journal ||
+                      ((sortie_jsonl != NULL || sortie_bin != NULL) && niveau <= niveau_fichiers) ||
+                      ((sortie_reprise != NULL || sortie_archive != NULL) && niveau <= JOURNAL_RESULTAT));
+}
+
+/**
+ * @brief attend une case libre dans l'anneau du thread appelant (créé au
+ * premier appel)
+ *
+ * @param ecrit reçoit le numéro de la case
+ * @return anneau*
+ */
+static anneau *attendre_case(uint_fast64_t *ecrit)
+{
+    // Un anneau d'une génération passée a été libéré par journal_fermer
+    unsigned g = atomic_load_explicit(&generation, memory_order_relaxed);
+    if (mon_anneau == NULL || ma_generation != g)
+    {
+        mon_anneau = nouvel_anneau();
+        ma_generation = g;
+    }
+
+    anneau *a = mon_anneau;
+    *ecrit = atomic_load_explicit(&a->ecrit, memory_order_relaxed);
+    while (*ecrit - atomic_load_explicit(&a->lu, memory_order_acquire) >= JOURNAL_TAILLE_ANNEAU)
+    {
+        sched_yield();
+    }
+    return a;
+}
+
+/**
+ * @brief Ajoute un evenement dans l'anneau du thread appelant. Si l'anneau est
+ * plein, le thread attend que l'écrivain le vide (aucun evenement perdu).
+ *
+ * @param niveau niveau de l'evenement
+ * @param type type de l'evenement
+ * @param tour numéro du tour
+ * @param num_match numéro du match dans le tour
+ * @param e1 premiére equipe du match
+ * @param e2 seconde equipe du match
+ * @param equipe equipe concernée (buteur, gagnant)
+ * @param score_e1 score de e1
+ * @param score_e2 score de e2
+ */
+void journal(int niveau, type_evenement type, int tour, int num_match, int e1, int e2, int equipe, int score_e1, int score_e2)
+{
+    if (!journal_actif(niveau))
+    {
+        return;
+    }
+
+    uint_fast64_t ecrit;
+    anneau *a = attendre_case(&ecrit);
+    evenement *ev = &a->ev[ecrit & (JOURNAL_TAILLE_ANNEAU - 1)];
+    ev->t_ns = maintenant_ns();
+    ev->num_match = num_match;
+    ev->e1 = e1;
+    ev->e2 = e2;
+    ev->equipe = equipe;
+    ev->tour = (int16_t)tour;
+    ev->type = (uint8_t)type;
+    ev->niveau = (uint8_t)niveau;
+    ev->score_e1 = (uint8_t)score_e1;
+    ev->score_e2 = (uint8_t)score_e2;
+    ev->reserve = 0;
+    atomic_store_explicit(&a->ecrit, ecrit + 1, memory_order_release);
+}
+
+/**
+ * @brief Ajoute des evenements journalisés par un processus fils (distribue.c) :
+ * ils gardent leur date et vont dans les fichiers, la sauvegarde et l'archive,
+ * mais ne sont pas affichés une seconde fois
+ *
+ * @param evenements les evenements, dans l'ordre du fils
+ * @param nbr leur nombre
+ */
+void journal_importer(const evenement *evenements, long nbr)
+{
+    for (long i = 0; i < nbr; i++)
+    {
+        if (!journal_actif(evenements[i].niveau))
+        {
+            continue;
+        }
+        uint_fast64_t ecrit;
+        anneau *a = attendre_case(&ecrit);
+        evenement *ev = &a->ev[ecrit & (JOURNAL_TAILLE_ANNEAU - 1)];
+        *ev = evenements[i];
+        ev->reserve |= JOURNAL_IMPORTE;
+        atomic_store_explicit(&a->ecrit, ecrit + 1, memory_order_release);
+    }
+}
+
+/**
+ * @brief Vide tous les anneaux, arrête le thread écrivain et ferme les sorties.
+ * Les threads qui journalisent doivent être terminés : leurs anneaux sont
+ * libérés. Un thread qui journalise aprés une réouverture du journal voit la
+ * génération changer et prend un nouvel anneau.
+ */
+void journal_fermer(void)
+{
+    if (!ouvert)
+    {
+        return;
+    }
+    atomic_store(&arret, 1);
+    pthread_join(ecrivain, NULL);
+    ouvert = 0;
+    fflush(stdout);
+
+    if (sortie_jsonl != NULL)
+    {
+        fclose(sortie_jsonl);
+    }
+    if (sortie_bin != NULL)
+    {
+        fclose(sortie_bin);
+    }
+    if (sortie_reprise != NULL)
+    {
+        fclose(sortie_reprise);
+        sortie_reprise = NULL;
+    }
+    if (sortie_archive != NULL)
+    {
+        archive_fermer(sortie_archive);
+        sortie_archive = NULL;
+    }
+
+    anneau *a = atomic_exchange(&anneaux, NULL);
+    while (a != NULL)
+    {
+        anneau *suivant = a->suivant;
+        free(a);
+        a = suivant;
+    }
+    mon_anneau = NULL;
+    atomic_fetch_add(&generation, 1);
+}
@@ -0,0 +1,73 @@
+/* journal.h */
+#ifndef JOURNAL_H
+#define JOURNAL_H
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include "equipes.h"
+
+/* Définitions des constantes */
+#define JOURNAL_TAILLE_ANNEAU 4096   // evenements par thread (puissance de 2)
+#define JOURNAL_PERIODE_FSYNC 100000000 // en nano seconde, entre deux fsync de la sauvegarde
+#define JOURNAL_ENTETE_BIN 12   // octets de l'en-tête du fichier binaire (signature, version, taille)
+
+// Niveaux : un evenement est affiché si son niveau <= niveau du journal, écrit
+// dans jsonl et bin si son niveau <= niveau des fichiers (JOURNAL_RESULTAT par défaut)
+#define JOURNAL_ESSENTIEL 0     // vainqueur du tournoi
+#define JOURNAL_RESULTAT 1      // resultat de chaque match
+#define JOURNAL_DETAIL 2        // coup d'envoi, buts, score final
+
+#define JOURNAL_IMPORTE 1       // drapeau de reserve : evenement d'un processus fils, déjà affiché
+
+/* Structures de données */
+
+typedef enum {
+    EV_COUP_ENVOI,
+    EV_BUT,
+    EV_SCORE_FINAL,
+    EV_GAGNANT,
+    EV_PENALTIES,
+    EV_VAINQUEUR,
+    EV_EXEMPT
+} type_evenement;
+
+// Enregistrement de taille fixe (c'est aussi le format du fichier binaire)
+typedef struct {
+    uint64_t t_ns;          // date de l'evenement (horloge monotone)
+    int32_t num_match;
+    int32_t e1;
+    int32_t e2;
+    int32_t equipe;         // equipe concernée (buteur, gagnant)
+    int16_t tour;
+    uint8_t type;
+    uint8_t niveau;
+    uint8_t score_e1;
+    uint8_t score_e2;
+    uint16_t reserve;       // 0 dans les fichiers
+} evenement;
+
+
+struct archive;     // archive.h
+
+
+/* ============================ Prototypes ============================ */
+// Démarre le thread écrivain ; jsonl, bin, la sauvegarde (reprise.h) et l'archive (archive.h)
+// sont optionnels (NULL)
+void journal_ouvrir(const table_equipes *equipes, int niveau, int fichiers, const char *jsonl, const char *bin,
+                    FILE *reprise, struct archive *arch);
+
+// Renvoie 1 si un evenement de ce niveau sera gardé
+int journal_actif(int niveau);
+
+// Ajoute un evenement dans l'anneau du thread appelant (sans verrou)
+void journal(int niveau, type_evenement type, int tour, int num_match, int e1, int e2, int equipe, int score_e1, int score_e2);
+
+// Ajoute des evenements d'un processus fils : fichiers, sauvegarde et archive seulement
+void journal_importer(const evenement *evenements, long nbr);
+
+// Vide tous les anneaux et arrête le thread écrivain ; les threads qui journalisent
+// doivent être terminés (joints) avant, leurs anneaux étant libérés
+void journal_fermer(void);
+
+#endif
@@ -11,716 +11,542 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
-#include <math.h>
 #include <time.h>
 #include <pthread.h>
 #include <stdint.h>
-#include <semaphore.h>
-#include <stdbool.h>
 #include <unistd.h>
+#include <getopt.h>
 
 #include "main.h"
+#include "pool.h"
+#include "journal.h"
+#include "alea.h"
+#include "montecarlo.h"
+#include "noyau.h"
+#include "mesures.h"
+#include "distribue.h"
+#include "reprise.h"
+#include "progression.h"
+#include "groupes.h"
+#include "archive.h"
+#include "annuaire.h"
 
-tournoi mon_tournoi;
-
-sem_t *equipe1;
-sem_t *equipe2;
-int team_count;
-int nbr_tours;
-pthread_mutex_t my_mutex,wait_match = PTHREAD_MUTEX_INITIALIZER;
-int *interrupteur;
-
+/**
+ * @brief affiche l'aide de la ligne de commande
+ *
+ * @param prog nom du programme
+ */
+static void usage(const char *prog)
+{
+    printf("Usage : %s [options] [fichier_equipes]\n", prog);
+    puts("  fichier_equipes      une equipe par ligne : \"nom\" ou \"nom,note\" (Elo, 1500 par défaut)");
+    puts("                       (sans fichier : nombre d'equipes demandé, noms générés)");
+    puts("      --generer N      génére N equipes sans rien demander (noms uniques AAA,");
+    puts("                       AAB, ... en parallèle sur -j workers)");
+    puts("      --prefixe P      préfixe des noms générés");
+    puts("  -q, --quiet          n'affiche que le vainqueur");
+    puts("  -r, --resultats      n'affiche que le resultat de chaque match");
+    puts("  -s, --seed N         graine : même graine, mêmes résultats");
+    puts("  -j, --workers N      nombre de workers (défaut : un par coeur)");
+    puts("  -P, --processus N    joue les premiers tours dans N processus fils (un sous");
+    puts("                       arbre chacun, -j workers par processus)");
+    puts("  -t, --tronquer       garde une puissance de 2 d'equipes au lieu d'exempter");
+    puts("                       les premiéres equipes du tour 0");
+    puts("  -g, --groupes T[,Q]  phase de groupes avant le tableau : groupes de T equipes");
+    puts("                       (dans l'ordre du fichier), chacun joue tous ses matchs,");
+    puts("                       les Q premiers (2 par défaut) passent au tableau");
+    puts("  -n, --tournois N     joue N tournois en lot et affiche en CSV la probabilité");
+    puts("                       de chaque equipe d'atteindre chaque tour");
+    puts("  -v, --vitesse X      facteur temps réel : 1 (défaut), 10, ... 0 = sans attente");
+    puts("                       (en temps réel, -j boucles d'evenements cadencent tous");
+    puts("                       les matchs en cours, sans un thread par match)");
+    puts("      --jsonl FICHIER  journal des evenements en JSON (une ligne par evenement)");
+    puts("      --bin FICHIER    journal des evenements en binaire");
+    puts("      --niveau-fichiers N  evenements écrits dans --jsonl et --bin, quel que soit");
+    puts("                       -q/-r : 0 vainqueur, 1 resultats (défaut), 2 détail");
+    puts("      --archive F      resultat de chaque match en colonnes binaires (lire avec");
+    puts("                       ./analyse F)");
+    puts("      --sauvegarde F   sauvegarde les resultats au fil du tournoi dans F");
+    puts("      --resume F       reprend le tournoi sauvegardé dans F (equipes, graine et");
+    puts("                       matchs déjà joués) et continue sa sauvegarde");
+    puts("      --renverser T,M  et si : aprés le tournoi, l'autre equipe gagne le match M");
+    puts("                       du tour T ; seuls les matchs en aval sont rejoués");
+    puts("      --remplacer P,EQUIPE  et si : l'equipe (nom ou id) échange sa place du");
+    puts("                       tour 0 avec la place P ; les deux chemins sont rejoués");
+    puts("      --query EQUIPE   parcours de l'equipe (nom ou id) aprés le tournoi :");
+    puts("                       adversaires, scores, tour d'élimination (répétable)");
+    puts("      --etat S         résumé d'une ligne sur stderr toutes les S secondes (tours");
+    puts("                       finis, matchs en cours, matchs/s, temps restant)");
+    puts("      --etat-socket F  les mêmes compteurs en JSON sur la socket UNIX F");
+    puts("                       (curl --unix-socket F http://localhost/)");
+    puts("      --mesures        histogrammes de latence par tour (attente dans la file,");
+    puts("                       attente de verrou, durée des matchs) sur stderr à la fin");
+    puts("                       et à chaque SIGUSR1");
+}
 
 /**
- * @brief lit les equipes dans un fichier donné et les sauvegarde dans une liste
+ * @brief affiche le parcours d'une equipe dans mon_tournoi (--query)
  *
- * @param filename le chemin du fichier texte (une equipe par ligne)
- * @param listeEquipes liste des equipes du tournoi
- * @param team_count nombre d'equipes du tournoi
+ * @param a l'annuaire de mes_equipes
+ * @param texte nom ou id de l'equipe
  */
-void read_teams(char *filename, Equipe *listeEquipes, int *team_count)
+static void afficher_parcours(const annuaire *a, const char *texte)
 {
-    FILE *fp = fopen(filename, "r");
-    if (fp == NULL)
+    Equipe e = annuaire_chercher(a, texte);
+    if (e < 0)
     {
-        perror("Erreur d'ouverture fichier");
-        exit(EXIT_FAILURE);
+        printf("Equipe %s inconnue\n", texte);
+        return;
     }
 
-    char *buffer = malloc(MAX_LENGTH_TEAM * sizeof(char));
-    if (buffer == NULL)
+    etape *etapes = malloc((nbr_tours + 1) * sizeof(etape));
+    if (etapes == NULL)
     {
         perror("Erreur allocation memoire");
         exit(EXIT_FAILURE);
     }
-
-    *team_count = 0;
-    while (fgets(buffer, MAX_LENGTH_TEAM, fp) != NULL)
+    int nbr = parcours(e, etapes);
+    int atteint = mon_tournoi.parcours[e].tour_atteint;
+    printf("Parcours de %.*s (id %d) : ", lg_nom_equipe(&mes_equipes, e), nom_equipe(&mes_equipes, e), mes_equipes.tab[e].id);
+    if (mon_tournoi.parcours[e].place < 0)
     {
-        buffer[strcspn(buffer, "\n")] = '\0';
-        inserer_queue(listeEquipes, buffer, (*team_count) + 1);
-        (*team_count)++;
+        puts("hors du tableau");
     }
-
-    fclose(fp);
-    free(buffer);
-}
-
-/**
- * @brief Garder le nombre d'equipe comme une puissance de 2 (on supprime les equipes excedentes)
- *
- * @param tete le liste des equipes
- * @param team_count le nombre d'equipes
- */
-void keep_power_of_two(Equipe *tete, int *team_count)
-{
-    // Vérification que la liste a au moins un élément
-    if (*tete == NULL)
+    else if (atteint == nbr_tours)
     {
-        return;
+        puts("vainqueur du tournoi");
     }
-
-    int power = 1;
-    int size = 2;
-    while (size <= *team_count)
+    else if (nbr > 0 && !etapes[nbr - 1].gagne)
     {
-        power++;
-        size *= 2;
+        printf("éliminé au tour %d\n", etapes[nbr - 1].tour);
     }
-
-    // Si le nombre d'éléments de la liste est déjà une puissance de 2, on ne fait rien
-    if (size == *team_count)
+    else
     {
-        return;
+        printf("qualifié pour le tour %d\n", atteint);
     }
-
-    int elements_to_remove = *team_count - (size / 2);
-    Equipe courant = *tete;
-    while (courant->suivant != NULL && elements_to_remove > 0)
+    for (int i = 0; i < nbr; i++)
     {
-        Equipe suivant = courant->suivant;
-        if (suivant->suivant == NULL)
+        const etape *et = &etapes[i];
+        if (et->adversaire < 0)
         {
-            free(suivant);
-            courant->suivant = NULL;
-            *team_count -= 1;
+            printf("\tTour %d : exempté\n", et->tour);
+            continue;
         }
-        else
-        {
-            while (suivant->suivant != NULL && suivant->suivant->suivant != NULL)
-            {
-                suivant = suivant->suivant;
-            }
-            free(suivant->suivant);
-            suivant->suivant = NULL;
-            *team_count -= 1;
-        }
-        elements_to_remove--;
+        printf("\tTour %d : %s %.*s %d-%d%s%s\n", et->tour, et->gagne ? "bat" : "perd contre",
+               lg_nom_equipe(&mes_equipes, et->adversaire), nom_equipe(&mes_equipes, et->adversaire),
+               et->score_pour, et->score_contre, (et->drapeaux & RESULTAT_PENALTIES) ? " (penalties)" : "",
+               (et->drapeaux & RESULTAT_RENVERSE) ? " (renversé)" : "");
     }
-}
-
-/**
- * @brief Fonction pour créer un nouveau nœud avec le nom d'équipe donné
- *
- * @param nom nom de l'equipe
- * @return Equipe
- */
-Equipe nouvelle_equipe(char *nom, int id)
-{
-    Equipe equipe = (Equipe)malloc(sizeof(struct equipe));
-    equipe->nom = (char *)malloc((strlen(nom) + 1) * sizeof(char)); // allouer suffisamment de mémoire pour le nom
-    strcpy(equipe->nom, nom);                                       // copier le nom donné dans la nouvelle zone de mémoire allouée
-    equipe->id = id;
-    equipe->suivant = NULL;
-    return equipe;
+    free(etapes);
 }
 
 
-
-
-/**
- * @brief Insérer une equipe en tete de liste
- *
- * @param tete un pointeur vers la tête de la liste chaînée
- * @param equipe l'équipe à insérer en tête
- */
-void inserer_tete(Equipe *tete, Equipe equipe)
+int main(int argc, char *argv[])
 {
-    equipe->suivant = *tete;
-    *tete = equipe;
-}
-
-
+    char *filename;
+    int niveau = JOURNAL_DETAIL;
+    int niveau_fichiers = JOURNAL_RESULTAT;
+    char *jsonl = NULL;
+    char *bin = NULL;
+    char *archive_matchs = NULL;
+    int graine_fixee = 0;
+    int nbr_workers = 0;
+    long nbr_tournois = 0;
+    int tronquer = 0;
+    int mesures = 0;
+    int nbr_processus = 0;
+    char *sauvegarde = NULL;
+    char *resume = NULL;
+    FILE *reprise = NULL;
+    int renverser_tour = -1, renverser_num = -1;
+    int remplacer_place = -1;
+    const char *remplacer_nom = NULL;
+    double periode_etat = 0;
+    char *socket_etat = NULL;
+    int taille_groupe = 0, nbr_qualifies = 2;
+    int nbr_generees = 0;
+    char **requetes = NULL;     // alloué au premier --query
+    int nbr_requetes = 0;
+    const char *prefixe = "";
+    team_count = 0;
 
-/**
- * @brief insére une equipe à la fin de la liste
- *
- * @param tete tete de la liste
- * @param nom nom de l'equipe
- */
-void inserer_queue(Equipe *tete, char *nom, int id)
-{
-    Equipe equipe = nouvelle_equipe(nom, id);
-    if (*tete == NULL)
-    {
-        // Si la liste est vide, le nouveau nœud devient la tête et la queue
-        *tete = equipe;
-    }
-    else
-    {
-        // Sinon, on parcourt la liste jusqu'à trouver le dernier nœud
-        Equipe courant = *tete;
-        while (courant->suivant != NULL)
+    static struct option options[] = {
+        {"quiet", no_argument, NULL, 'q'},
+        {"resultats", no_argument, NULL, 'r'},
+        {"vitesse", required_argument, NULL, 'v'},
+        {"seed", required_argument, NULL, 's'},
+        {"workers", required_argument, NULL, 'j'},
+        {"tournois", required_argument, NULL, 'n'},
+        {"processus", required_argument, NULL, 'P'},
+        {"tronquer", no_argument, NULL, 't'},
+        {"groupes", required_argument, NULL, 'g'},
+        {"generer", required_argument, NULL, 'G'},
+        {"prefixe", required_argument, NULL, 'F'},
+        {"jsonl", required_argument, NULL, 'J'},
+        {"bin", required_argument, NULL, 'B'},
+        {"niveau-fichiers", required_argument, NULL, 'L'},
+        {"archive", required_argument, NULL, 'A'},
+        {"mesures", no_argument, NULL, 'M'},
+        {"sauvegarde", required_argument, NULL, 'S'},
+        {"resume", required_argument, NULL, 'R'},
+        {"renverser", required_argument, NULL, 'X'},
+        {"remplacer", required_argument, NULL, 'W'},
+        {"query", required_argument, NULL, 'Y'},
+        {"etat", required_argument, NULL, 'E'},
+        {"etat-socket", required_argument, NULL, 'U'},
+        {"help", no_argument, NULL, 'h'},
+        {NULL, 0, NULL, 0}};
+    int opt;
+    while ((opt = getopt_long(argc, argv, "qrv:s:j:n:P:tg:h", options, NULL)) != -1)
+    {
+        switch (opt)
         {
-
-            courant = courant->suivant;
+        case 'q':
+            niveau = JOURNAL_ESSENTIEL;
+            break;
+        case 'r':
+            niveau = JOURNAL_RESULTAT;
+            break;
+        case 'v':
+            vitesse = atof(optarg);
+            if (vitesse < 0)
+            {
+                vitesse = 0;
+            }
+            break;
+        case 's':
+            graine = strtoull(optarg, NULL, 0);
+            graine_fixee = 1;
+            break;
+        case 'j':
+            nbr_workers = atoi(optarg);
+            break;
+        case 'n':
+            nbr_tournois = atol(optarg);
+            break;
+        case 'P':
+            nbr_processus = atoi(optarg);
+            break;
+        case 't':
+            tronquer = 1;
+            break;
+        case 'J':
+            jsonl = optarg;
+            break;
+        case 'B':
+            bin = optarg;
+            break;
+        case 'L':
+            niveau_fichiers = atoi(optarg);
+            if (niveau_fichiers < JOURNAL_ESSENTIEL || niveau_fichiers > JOURNAL_DETAIL)
+            {
+                usage(argv[0]);
+                return 1;
+            }
+            break;
+        case 'A':
+            archive_matchs = optarg;
+            break;
+        case 'M':
+            mesures = 1;
+            break;
+        case 'S':
+            sauvegarde = optarg;
+            break;
+        case 'R':
+            resume = optarg;
+            break;
+        case 'E':
+            periode_etat = atof(optarg);
+            break;
+        case 'U':
+            socket_etat = optarg;
+            break;
+        case 'G':
+            nbr_generees = atoi(optarg);
+            break;
+        case 'F':
+            prefixe = optarg;
+            break;
+        case 'g':
+            if (sscanf(optarg, "%d,%d", &taille_groupe, &nbr_qualifies) < 1 || taille_groupe < 2 || nbr_qualifies < 1)
+            {
+                usage(argv[0]);
+                return 1;
+            }
+            break;
+        case 'Y':
+            if (requetes == NULL)
+            {
+                requetes = malloc(argc * sizeof(char *));
+                if (requetes == NULL)
+                {
+                    perror("Erreur allocation memoire");
+                    exit(EXIT_FAILURE);
+                }
+            }
+            requetes[nbr_requetes++] = optarg;
+            break;
+        case 'X':
+            if (sscanf(optarg, "%d,%d", &renverser_tour, &renverser_num) != 2)
+            {
+                usage(argv[0]);
+                return 1;
+            }
+            break;
+        case 'W':
+        {
+            int lu = 0;
+            if (sscanf(optarg, "%d,%n", &remplacer_place, &lu) != 1 || lu == 0 || optarg[lu] == '\0' || remplacer_place < 0)
+            {
+                usage(argv[0]);
+                return 1;
+            }
+            remplacer_nom = optarg + lu;
+            break;
+        }
+        case 'h':
+            usage(argv[0]);
+            return 0;
+        default:
+            usage(argv[0]);
+            return 1;
         }
-        // On insère le nouveau nœud en queue
-        courant->suivant = equipe;
     }
-}
 
-/**
- * @brief Supprime et récupére la tête (equipe) de la liste
- *
- * @param tete la liste des equipes
- * @return Equipe
- */
-Equipe pop_tete(Equipe *tete)
-{
-    if (*tete == NULL)
+    if (mesures)
     {
-        printf("La liste chaînée est vide.\n");
-        return NULL;
+        // Avant tout thread : ils héritent du masque qui bloque SIGUSR1
+        mesures_activer();
     }
 
-    Equipe equipe_supprimee = *tete;
-    *tete = (*tete)->suivant;
-    equipe_supprimee->suivant = NULL;
-    return equipe_supprimee;
-}
-
-/**
- * @brief Fonction pour afficher la liste chaînée d'équipes
- *
- * @param tete la liste des equipes
- */
-void afficher_equipes(Equipe tete)
-{
-    Equipe courant = tete;
-    while (courant != NULL)
+    if (!graine_fixee)
     {
-        printf("\tid:%d, nom: %s\n", courant->id, courant->nom);
-        courant = courant->suivant;
+        graine = (uint64_t)time(NULL); // initialiser generateur aleatoire
     }
-}
 
-/**
- * @brief Fonction pour libérer la mémoire allouée pour chaque nœud de la liste chaînée
- *
- * @param tete la liste des equipes
- */
-void liberer_equipes(Equipe tete)
-{
-    Equipe courant = tete;
-    while (courant != NULL)
+    // Récupération du nom de fichier à partir des arguments de la ligne de commande (ou utilisation par défaut)
+    if (resume != NULL)
     {
-        Equipe suivant = courant->suivant;
-        free(courant->nom); // libérer la mémoire allouée pour le nom d'équipe
-        free(courant);      // libérer la mémoire allouée pour le nœud
-        courant = suivant;
+        // Equipes et graine viennent de la sauvegarde
+        mes_equipes = nouvelle_table_equipes(0);
+        reprise = reprise_charger(resume, &mes_equipes, &graine);
     }
-}
-
-/**
- * @brief Crée un tableau de liste d'equipe (Chaque indice du tableau correspond à un tour du tournoi)
- *
- * @param nbrTour Nombre de tour du tournoi
- * @return t un tournoi
- */
-tournoi nouveau_tournoi(int nbrTour)
-{
-    tournoi t;
-    t.nbrTour = nbrTour;
-    t.tour = malloc(nbrTour * sizeof(Equipe));
-    for (int i = 0; i < nbrTour; i++)
+    else if (optind >= argc)
     {
-        t.tour[i] = NULL;
+        // Avec --generer ou -n, stdout est réservé au tableau ou au CSV
+        FILE *annonces = (nbr_generees > 0 || nbr_tournois > 0) ? stderr : stdout;
+        int nbr_equipe = nbr_generees;
+        if (nbr_equipe <= 0)
+        {
+            fputs("Entrez le nombre d'equipe\n", annonces);
+            scanf("%d", &nbr_equipe);
+        }
+        if (tronquer && !is_power_two(nbr_equipe))
+        {
+            nbr_equipe = nearest_power_two(nbr_equipe);
+            fprintf(annonces, "Le nombre n'est pas une puissance de 2 et a été modifié, nouvelle valeur : %d\n", nbr_equipe);
+        }
+        fputs("Generation des equipes...\n", annonces);
+        mes_equipes = nouvelle_table_equipes(0);
+        pool *workers = pool_creer(nbr_workers);
+        generer_equipes(&mes_equipes, nbr_equipe, prefixe, workers);
+        pool_detruire(workers);
     }
-    return t;
-}
-
-/**
- * @brief Récupérer la liste des equipes d'un tour i
- *
- * @param t structure contenant les tours (tableau de liste d'equipe)
- * @param index tour desiré
- * @return Equipe
- */
-Equipe get_equipe_tournoi(tournoi t, int index_tour)
-{
-    if (index_tour < 0 || index_tour >= t.nbrTour)
+    else
     {
-        printf("Index hors limite.\n");
-        return NULL;
-    }
-    return t.tour[index_tour];
-}
+        filename = argv[optind];
+        // Lecture des équipes à partir du fichier
+        mes_equipes = nouvelle_table_equipes(0);
+        read_teams(filename, &mes_equipes);
 
-/**
- * @brief Insérer une equipe dans un tour i
- *
- * @param t structure contenant les tours (tableau de liste d'equipe)
- * @param index_tour tour désiré
- * @param equipe equipe à inserer
- */
-void inserer_equipe_tournoi(tournoi t, int index_tour, Equipe equipe)
-{
-    if (index_tour < 0 || index_tour >= t.nbrTour)
-    {
-        printf("insert : Index %d hors limite.\n",index_tour);
-        
-        
-    } else {
-        inserer_tete(&t.tour[index_tour], equipe);
+        if (tronquer)
+        {
+            // Garder qu'un nombre puissance de 2 des equipes
+            keep_power_of_two(&mes_equipes);
+        }
     }
-   
-}
 
-/**
- * @brief Affiche toutes les équipes de chaque tour
- *
- * @param t structure contenant les tours (tableau de liste d'equipe)
- */
-void afficher_equipe_tournoi(tournoi t)
-{
-    printf("=======Tournoi=======\n");
-    for (int i = 0; i < t.nbrTour; i++)
+    if (taille_groupe > 0 && resume == NULL)
     {
-        printf("-Equipes du tour %d :\n", i);
-        afficher_equipes(t.tour[i]);
+        // Les qualifiés remplacent les equipes : le tableau (et sa sauvegarde) ne connait qu'eux
+        pool *workers = pool_creer(nbr_workers);
+        table_equipes qualifies = phase_de_groupes(workers, &mes_equipes, taille_groupe, nbr_qualifies, graine,
+                                                   niveau == JOURNAL_DETAIL && nbr_tournois == 0);
+        pool_detruire(workers);
+        liberer_table_equipes(&mes_equipes);
+        mes_equipes = qualifies;
+        if (tronquer)
+        {
+            keep_power_of_two(&mes_equipes);
+        }
     }
-}
+    team_count = mes_equipes.nbr;
 
-/**
- * @brief Libérer le tableau des tours (fin du tournoi)
- *
- * @param t structure contenant les tours (tableau de liste d'equipe)
- */
-void liberer_equipe_tournoi(tournoi t)
-{
-    for (int i = 0; i < t.nbrTour; i++)
+    // Affichage des équipes lues à partir du fichier
+
+    // En mode lot, stdout est réservé au CSV
+    FILE *info = (nbr_tournois > 0) ? stderr : stdout;
+    fprintf(info, "Nombre d'equipe %d (graine %llu)\n", team_count, (unsigned long long)graine);
+    if (team_count < 2)
     {
-        liberer_equipes(t.tour[i]);
+        puts("Il faut au moins 2 equipes");
+        free(requetes);
+        return 2;
     }
-    free(t.tour);
-}
-
-
-
-/**
- * @brief Supprimer et récupérer une equipe d'un tour i
- *
- * @param t structure contenant les tours (tableau de liste d'equipe)
- * @param index_tour tour désiré
- * @return Equipe
- */
-Equipe pop_equipe_at_tour(tournoi *t, int index_tour)
-{
-    return pop_tete(&(t->tour[index_tour]));
-}
-
-
-
-/**
- * @brief genere un nom aleatoire en majuscule de taille 3
- * 
- * @return char* le nom généré
- */
-char *generer_nom_equipe()
-{
-    static char name[4];
-
-    name[0] = 'A' + rand() % 26; // 1er caractere
-    name[1] = 'A' + rand() % 26; // 2er caractere
-    name[2] = 'A' + rand() % 26; // 3er caractere
-    name[3] = '\0';              // fin de chaine
 
-    return name;
-}
-
-
-
-
-/**
- * @brief Verifie si un entier est une puissance de 2
- *
- * @param n le nombre entier
- * @return int
- */
-int is_power_two(int n)
-{
-    if (n <= 0)
+    // Plus petit nombre de tours pour que chaque equipe ait sa place
+    nbr_tours = 0;
+    while ((1 << nbr_tours) < team_count)
     {
-        return 0;
+        nbr_tours++;
     }
-    return (n & (n - 1)) == 0;
-}
 
-/**
- * @brief Renvoie la puissanec de 2 la plus proche inférieur à n
- *
- * @param n le nombre entier
- * @return int
- */
-int nearest_power_two(int n)
-{
-    if (n <= 0)
-    {
+    mon_tournoi = nouveau_tournoi(nbr_tours);
+    start_tournoi(&mon_tournoi, &mes_equipes);
+
+    if (nbr_tournois > 0)
+    {
+        // Mode lot : N tournois sans journal ni attente
+        struct timespec debut, fin;
+        pool *workers = pool_creer(nbr_workers);
+        clock_gettime(CLOCK_MONOTONIC, &debut);
+        stats_montecarlo stats = montecarlo(workers, &mes_equipes, mon_tournoi.tour[0], mon_tournoi.taille, nbr_tours, nbr_tournois, graine);
+        clock_gettime(CLOCK_MONOTONIC, &fin);
+
+        double duree = (fin.tv_sec - debut.tv_sec) + (fin.tv_nsec - debut.tv_nsec) / 1e9;
+        fprintf(stderr, "%ld tournois en %.3f s (%.0f tournois/s, %d workers, noyau %s)\n",
+                nbr_tournois, duree, nbr_tournois / duree, workers->nbr_workers, noyau_isa());
+        pool_detruire(workers);
+        if (mesures)
+        {
+            mesures_resume(stderr);
+        }
+        afficher_montecarlo(&stats, &mes_equipes, stdout);
+        liberer_montecarlo(&stats);
+        liberer_equipe_tournoi(mon_tournoi);
+        liberer_table_equipes(&mes_equipes);
+        free(requetes);
         return 0;
     }
-    int i = 0;
-    while ((1 << i) <= n)
+
+    // Index des noms et ids, construit une fois pour toutes les requetes
+    annuaire index_equipes;
+    int avec_index = (nbr_requetes > 0 || remplacer_nom != NULL);
+    if (avec_index)
     {
-        i++;
+        index_equipes = annuaire_creer(&mes_equipes);
     }
-    return (1 << (i - 1));
-}
 
-/**
- * @brief débute le tournoi en plaçant toutes les equipe au tour 0
- *
- * @param t un tournoi donné
- * @param e une liste d'equipe
- */
-void start_tournoi(tournoi *t, Equipe e)
-{
-    (*t).tour[0] = e;
-}
-
-
-
-Equipe simuler_match(Equipe e1, Equipe e2, int tour)
-{
-
-    int temps = 0;
-    int score_e1 = 0;
-    int score_e2 = 0;
-    // Simuler le match
-    printf("\033[0;33m[Tour %d]\033[0m Coup d'envoi entre %s et %s\n", tour, e1->nom, e2->nom);
-    while (temps < DUREE_MATCH)
+    if (reprise != NULL)
     {
-        // Simuler une action
-        if (rand() % 5 == 0)
-        { // 1 chance sur 10 de marquer un but
-            if (rand() % 2 == 0)
-            {               // si l'équipe 1 marque
-                score_e1++; // incrémenter le score de l'équipe 1
-                printf("\033[0;33m[Tour %d]\033[0m %s a marqué !\n\t %s %d - %d %s\n", tour, e1->nom, e1->nom, score_e1, score_e2, e2->nom);
-            }
-            else
-            {               // si l'équipe 2 marque
-                score_e2++; // incrémenter le score de l'équipe 2
-                printf("\033[0;33m[Tour %d]\033[0m %s a marqué !\n\t %s %d - %d %s\n", tour, e2->nom, e1->nom, score_e1, score_e2, e2->nom);
-            }
-        }
-        temps++;
-        usleep(rand() % MAX_DUREE_ACTION); // attendre 100 ms avant de simuler l'action suivante
+        printf("Reprise : %ld matchs déjà joués\n", reprise_appliquer());
     }
-
-    printf("\033[0;33m[Tour %d]\033[0m Score final : %s %d - %d %s\n", tour, e1->nom, score_e1, score_e2, e2->nom);
-    // Déterminer l'équipe gagnante
-    if (score_e1 > score_e2)
+    else if (sauvegarde != NULL)
     {
-        printf("\033[0;33m[Tour %d] \033[0m\033[0;32mEquipe gagnante : %s\033[0m\n", tour, e1->nom);
-        return e1; // l'équipe 1 est la gagnante
+        reprise = reprise_creer(sauvegarde, &mes_equipes, graine);
     }
-    else if (score_e2 > score_e1)
+
+    if (niveau == JOURNAL_DETAIL)
     {
-        printf("\033[0;33m[Tour %d] \033[0m\033[0;32mEquipe gagnante : %s\033[0m\n", tour, e2->nom);
-        return e2; // l'équipe 2 est la gagnante
+        afficher_equipe_tournoi(mon_tournoi);
     }
-    else
+
+    // L'archive date ses matchs depuis sa création : avant les fils, dont les matchs y vont aussi
+    archive *arch = (archive_matchs != NULL) ? archive_creer(archive_matchs, &mes_equipes, graine) : NULL;
+
+    // Mode distribué : les processus fils jouent les premiers tours, le
+    // coordinateur reprend au tour où il reste un qualifié par processus
+    int tour_reprise = 0;
+    evenements_fils ev_fils = {NULL, 0};
+    if (nbr_processus > 1)
     {
-        if (rand() % 2 == 0)
+        // Evenements des fils voulus par les fichiers, la sauvegarde et l'archive du coordinateur
+        int transfert = -1;
+        if (reprise != NULL || arch != NULL)
         {
-            printf("\033[0;33m[Tour %d]\033[0m \033[0;32mScore nul, l'equipe %s gagne grâce aux penalties\033[0m\n", tour, e1->nom);
-            return e1;
+            transfert = JOURNAL_RESULTAT;
         }
-        else
+        if ((jsonl != NULL || bin != NULL) && niveau_fichiers > transfert)
         {
-            printf("\033[0;33m[Tour %d]\033[0m \033[0;32mScore nul, l'equipe %s gagne grâce aux penalties\033[0m\n", tour, e2->nom);
-            return e2;
+            transfert = niveau_fichiers;
         }
+        tour_reprise = simuler_sous_tournois(nbr_processus, nbr_workers, niveau, transfert, &ev_fils);
     }
-}
-
+    journal_ouvrir(&mes_equipes, niveau, niveau_fichiers, jsonl, bin, reprise, arch);
+    journal_importer(ev_fils.tab, ev_fils.nbr);
+    free(ev_fils.tab);
 
+    // Pool de workers borné au nombre de coeurs
+    pool *workers = pool_creer(nbr_workers);
+    printf("Pool de %d workers\n", workers->nbr_workers);
 
-void toggle(int* state) {
-  *state ^= 1;
-}
-
-
-void print_val_of_sem_tour(sem_t *sem,char* nom_sem)
-{
-    int value,i;
-    printf("%s[",nom_sem);
-    for (i=0;i<nbr_tours;i++) {
-        sem_getvalue(&sem[i], &value);
-        printf("%d ", value);
-    }
-     printf("]\n");
-}
-
-
-int *init_interrupteurs(int nbr_tours) {
-    int* interrupteur = malloc(nbr_tours * sizeof(int));
-    for(int i=0;i<nbr_tours;i++) {
-        interrupteur[i]=0;
-    }
-    return interrupteur;
-}
-
-
-
-
-/**
- * @brief simule un tour du tournoi
- *
- * @param arg numéro du tour
- * @return void*
- */
-void *simuler_tour(void *arg)
-{
-    int tour = (int)(intptr_t)arg;
-     
-    int nbr_match = (team_count / (tour+1))/2;
-    int value;
-    
-    match *m = malloc(nbr_match * sizeof(match));
-    pthread_t *threads_match = malloc(nbr_match * sizeof(pthread_t));
-    // Lancer les matchs parallélement
-    
-    for (int i = 0; i < nbr_match; i++)
+    if (periode_etat > 0 || socket_etat != NULL)
     {
-        m[i].num_match = i;
-        m[i].num_tour = tour;
-         printf("==============je suis tour %d , m.tour %d , m.match %d\n",tour,m[i].num_tour, m[i].num_match);
-        if (pthread_create(&threads_match[i], NULL, thread_function_match, &m[i]) != 0)
-        {
-            perror("Erreur lors de creation thread tour");
-            return (void *)1; // Erreur creation thread tournoi
-        }
-        
-        // puts("");
+        progression_demarrer(periode_etat, socket_etat);
     }
-    
-    Equipe eg = (Equipe)malloc(nbr_match * sizeof(struct equipe));
-    int status;
-    for (int i = 0; i < nbr_match; i++)
+    simuler_tours(workers, tour_reprise, nbr_tours, 0, 1);
+    progression_arreter();
+    pool_detruire(workers);
+    journal_fermer();
+    if (mesures)
     {
-        if (pthread_join(threads_match[i], (void**)&status) != 0)
-        {
-            perror("Erreur lors de join thread tour");
-            return (void *)1; // Erreur lors du join des threads tour
-        }
-        printf("j'ai fini tour %d thread_match %d with status %d\n",tour,  i, status);
-        
+        mesures_resume(stderr);
     }
 
-    free(threads_match);
-
-    printf("j'ai fini simuler tour %d\n",tour);
-    return NULL;
-}
-
-
-
-
-
-void *thread_function_match(void *arg)
-{
-
-    match m = *(match*)arg;
-    Equipe eg = malloc(sizeof(struct equipe));
-   
-    int tour = m.num_tour;
-    int num_match = m.num_match;
-    sem_wait(&equipe1[tour]);
-    print_val_of_sem_tour(equipe1,"sem_equipe1");
-    printf("tour %d match %d passed equipe1\n",tour,num_match);
-    sem_wait(&equipe2[tour]);
-    print_val_of_sem_tour(equipe2,"sem_equipe2");
-    printf("tour %d match %d passed equipe2\n",tour,num_match);
-
-    pthread_mutex_lock(&my_mutex);
-    // debut_SC
-        Equipe e1 = pop_equipe_at_tour(&mon_tournoi, tour);
-        Equipe e2 = pop_equipe_at_tour(&mon_tournoi, tour);
-    // fin_SC
-    pthread_mutex_unlock(&my_mutex);
-
-    /* Simuler le match */
-     eg = simuler_match(e1, e2, tour);
-    //usleep(rand()%100000);
-    printf("---- fin tour %d match %d\n",tour,num_match);
-    pthread_mutex_lock(&my_mutex);
-        if (tour<nbr_tours) {
-            printf("__tour %d < nbr_tour %d\n",tour,nbr_tours);
-            toggle(&interrupteur[tour]);
-            if (interrupteur[tour]){
-                
-                sem_post(&equipe1[tour+1]);
-            } else {
-                sem_post(&equipe2[tour+1]);
-            }
-             inserer_equipe_tournoi(mon_tournoi, tour + 1, eg);
-             afficher_equipe_tournoi(mon_tournoi);
-        }
-        
-    pthread_mutex_unlock(&my_mutex);
-
-   
-    /* Retourner l'equipe gagnante */
-     
-    return NULL;
-}
-
-
-
-
-
-int main(int argc, char *argv[])
-{
-    char *filename;
-    int i;
-    int fin_tournoi = 0;
-    int tour = 0;
-    Equipe mes_equipes;
-    team_count = 0;
-
-    srand(time(NULL)); // initialiser generateur aleatoire
-
-    // Récupération du nom de fichier à partir des arguments de la ligne de commande (ou utilisation par défaut)
-    if (argc < 2)
+    if (renverser_tour >= 0)
     {
-        puts("Entrez le nombre d'equipe");
-        int nbr_equipe = 0;
-        scanf("%d", &nbr_equipe);
-        if (!is_power_two(nbr_equipe))
+        // Journal fermé : le chemin rejoué n'entre ni dans l'affichage ni dans la sauvegarde
+        int rejoues = renverser_match(renverser_tour, renverser_num);
+        if (rejoues < 0)
         {
-            nbr_equipe = nearest_power_two(nbr_equipe);
-            printf("Le nombre n'est pas une puissance de 2 et a été moifié, nouvelle valeur : %d", nbr_equipe);
+            printf("Et si : le match %d du tour %d n'existe pas ou n'a pas été joué\n", renverser_num, renverser_tour);
         }
-        puts("Generation des equipes...");
-        char name[4];
-        for (i = 0; i < nbr_equipe; i++)
+        else
         {
-            strcpy(name, generer_nom_equipe());
-            inserer_queue(&mes_equipes, name, i + 1);
-            team_count++;
+            Equipe v = mon_tournoi.tour[nbr_tours][0];
+            printf("Et si le match %d du tour %d était renversé : %d matchs rejoués, vainqueur : %.*s\n",
+                   renverser_num, renverser_tour, rejoues, lg_nom_equipe(&mes_equipes, v), nom_equipe(&mes_equipes, v));
         }
     }
-    else
-    {
-        filename = argv[1];
-        // Lecture des équipes à partir du fichier
-        read_teams(filename, &mes_equipes, &team_count);
 
-        // Garder qu'un nombre puissance de 2 des equipes
-        keep_power_of_two(&mes_equipes, &team_count);
-    }
-
-    // Affichage des équipes lues à partir du fichier
-
-    printf("Nombre d'equipe %d\n", team_count);
-
-    nbr_tours = (int)log2((double)team_count);
-
-    mon_tournoi = nouveau_tournoi(nbr_tours);
-
-    start_tournoi(&mon_tournoi, mes_equipes);
-    afficher_equipe_tournoi(mon_tournoi);
-    // Création d'interrupteurs pour usage avec les semaphores
-    interrupteur = init_interrupteurs(nbr_tours);
-
-    /* Tableau de semaphores pour le nombre d'equipes Home(1) et Away(2) pour chaque tour */
-    equipe1 = malloc(nbr_tours * sizeof(sem_t));
-    equipe2 = malloc(nbr_tours * sizeof(sem_t));
-
-    /* Initialisation des semaphores */
-        if (sem_init(&equipe1[0], 0, team_count/2) == -1)
-    {
-        perror("Erreur initialisation semaphore");
-        return 3; // Erreur création semaphore
-    }
-
-        if (sem_init(&equipe2[0], 0, team_count/2) == -1)
+    if (remplacer_nom != NULL)
     {
-        perror("Erreur initialisation semaphore");
-        return 3; // Erreur création semaphore
-    }
-
-    for (i = 1; i < nbr_tours; i++)
-    {
-        if (sem_init(&equipe1[i], 0, 0) == -1)
+        Equipe e = annuaire_chercher(&index_equipes, remplacer_nom);
+        int rejoues = (e < 0) ? -1 : remplacer_equipe(remplacer_place, e);
+        if (rejoues < 0)
         {
-            perror("Erreur initialisation semaphore");
-            return 3; // Erreur création semaphore
+            printf("Et si : equipe %s inconnue, ou place %d vide ou inexistante\n", remplacer_nom, remplacer_place);
         }
-
-        if (sem_init(&equipe2[i], 0, 0) == -1)
+        else
         {
-            perror("Erreur initialisation semaphore");
-            return 3; // Erreur création semaphore
+            Equipe v = mon_tournoi.tour[nbr_tours][0];
+            printf("Et si %.*s prenait la place %d : %d matchs rejoués, vainqueur : %.*s\n",
+                   lg_nom_equipe(&mes_equipes, e), nom_equipe(&mes_equipes, e), remplacer_place, rejoues,
+                   lg_nom_equipe(&mes_equipes, v), nom_equipe(&mes_equipes, v));
         }
-        
     }
 
-    print_val_of_sem_tour(equipe1,"sem_equipe1");
-    
-
-    
-    pthread_t *threads_tour = malloc(nbr_tours * sizeof(pthread_t));
-
-
-    // Lancer les tours parallélement
-    for (i = 0; i < nbr_tours; i++)
+    for (int i = 0; i < nbr_requetes; i++)
     {
-        if (pthread_create(&threads_tour[i], NULL, simuler_tour, (void *)(intptr_t)i) != 0)
-        {
-            perror("Erreur lors de creation thread tour");
-            return 1; // Erreur creation thread tournoi
-        };
+        afficher_parcours(&index_equipes, requetes[i]);
     }
-
-    int  status;
-    for (int i = 0; i < nbr_tours; i++)
+    if (avec_index)
     {
-        
-        if (pthread_join(threads_tour[i], (void**)&status) != 0)
-        {
-            perror("Erreur lors de join thread tour");
-            return 1; // Erreur lors du join des threads tour
-        }
-        printf("Thread_tour %d exit status %d\n",i,status);
-        
+        annuaire_liberer(&index_equipes);
     }
+    free(requetes);
 
-    
+    if (niveau == JOURNAL_DETAIL)
+    {
+        afficher_equipe_tournoi(mon_tournoi);
+    }
 
     // Libération mémoire
 
-    free(threads_tour);
-
-    for (i = 0; i < nbr_tours; i++)
-    {
-        sem_destroy(&equipe1[i]);
-        sem_destroy(&equipe2[i]);
-    }
-    pthread_mutex_destroy(&my_mutex);
+    liberer_equipe_tournoi(mon_tournoi);
+    liberer_table_equipes(&mes_equipes);
 
      printf("j'ai fini main\n");
     return 0;
-}
\ No newline at end of file
+}
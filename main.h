@@ -1,65 +1,102 @@
 /* main.h */
+#include <stdatomic.h>
+
+#include "equipes.h"
+#include "pool.h"
+#include "arene.h"
 
 /* Définitions des constantes */
-#define MAX_LENGTH_TEAM 50  // nombre carac max du nom d'equipe
 #define MAX_DUREE_ACTION 500000   // en micro seconde
 #define DUREE_MATCH 5
 
-/* Structures de données */
+// Drapeaux d'un resultat_match
+#define RESULTAT_JOUE 1         // le match a été joué
+#define RESULTAT_PENALTIES 2    // score nul, décidé aux penalties
+#define RESULTAT_RENVERSE 4     // vainqueur inversé aprés coup (renverser_match)
 
+/* Structures de données */
 
-typedef struct equipe {
-    int id;
-    char *nom;
-    struct equipe *suivant;
-} *Equipe;
 
 typedef struct {
-    int nbrTour;
-    Equipe *tour;
-} tournoi;
+    int num_match;
+    int num_tour;
+    atomic_int attente;     // nombre d'equipes encore attendues avant de jouer
+    uint64_t pret_ns;       // date où le match est devenu jouable (mesures)
+} match;
 
 
+// Etat d'un match en cours, joué action par action (partie_debut, partie_action, partie_fin)
 typedef struct {
+    alea a;                 // flux aléatoire du match
+    uint32_t seuil;         // seuil de but de e1 (modele.h)
+    Equipe e1;
+    Equipe e2;
+    int tour;
     int num_match;
-    int num_tour;
-} match;
+    uint8_t temps;          // actions déjà jouées
+    uint8_t score_e1;
+    uint8_t score_e2;
+} partie;
 
 
+// Resultat d'un match, rangé par id_match (4 octets)
+typedef struct {
+    uint8_t score_e1;
+    uint8_t score_e2;
+    uint8_t drapeaux;
+    uint8_t reserve;
+} resultat_match;
 
-/* ============================ Prototypes ============================ */
-// FLit les équipes ligne par ligne depuis un fichier texte et les sauvegarder dans un tableau
-void read_teams(char* filename, Equipe* listeEquipes, int* team_count);
 
-// Garde le nombre d'equipe comme une puissance de 2 (on supprime les equipes excedentes)
-void keep_power_of_two(Equipe* tete, int* team_count);
+// Parcours d'une equipe, tenu à jour au fil du tournoi : sa place au tour 0
+// (-1 hors du tableau) et le dernier tour atteint (nbrTour pour le vainqueur)
+typedef struct {
+    int32_t place;
+    int32_t tour_atteint;
+} parcours_equipe;
 
-// crée une nouvelle equipe
-Equipe nouvelle_equipe(char* nom, int id);
 
-// insére une equipe en tete de liste
-void inserer_tete(Equipe* tete, Equipe equipe);
+// Une étape du parcours d'une equipe (voir parcours)
+typedef struct {
+    int tour;
+    Equipe adversaire;      // -1 : exempté
+    int score_pour;
+    int score_contre;
+    int drapeaux;           // drapeaux du resultat_match
+    int gagne;
+} etape;
 
-// insérer une equipe en queue de liste
-void inserer_queue(Equipe* tete, char* nom, int id);
 
-// supprime la tête de la liste chaînée et renvoyer l'équipe supprimée
-Equipe pop_tete(Equipe* tete);
+typedef struct {
+    int nbrTour;
+    int taille;         // nombre d'equipes au tour 0
+    Equipe **tour;      // tour[i] : tableau dense des equipes du tour i, tour[nbrTour] : vainqueur
+    match *matchs;      // arbre du tournoi : tous les matchs, rangés tour par tour
+    resultat_match *resultats;  // score de chaque match, rangés comme matchs
+    parcours_equipe *parcours;  // parcours de chaque equipe (taille equipes au plus)
+    arene memoire;      // porte tour, ses places et matchs (libérée d'un coup)
+} tournoi;
+
 
-//  affiche la liste chaînée d'équipes
-void afficher_equipes(Equipe tete);
 
-// libére la mémoire allouée pour chaque nœud de la liste chaînée
-void liberer_equipes(Equipe tete);
+/* Etat global du tournoi (tournoi.c) */
+extern table_equipes mes_equipes;
+extern tournoi mon_tournoi;
+extern int team_count;
+extern int nbr_tours;
+extern double vitesse;
+extern uint64_t graine;
 
-// Crée un tableau de liste d'equipe (Chaque indice du tableau correspond à un tour du tournoi)
+
+/* ============================ Prototypes ============================ */
+// Crée le tableau des tours (Chaque indice correspond à un tour du tournoi)
 tournoi nouveau_tournoi(int nbrTour);
 
-// Récupére la liste des equipes d'un tour i
-Equipe get_equipe_tournoi(tournoi t, int index_tour);
+// Récupére le tableau des equipes d'un tour i
+Equipe *get_equipe_tournoi(tournoi t, int index_tour);
 
-// Insére une equipe dans un tour i
-void inserer_equipe_tournoi(tournoi t, int index_tour, Equipe equipe);
+// Insére une equipe à une place d'un tour i
+void inserer_equipe_tournoi(tournoi t, int index_tour, int place, Equipe equipe);
 
 // Affiche toutes les équipes de chaque tour
 void afficher_equipe_tournoi(tournoi t);
@@ -67,11 +104,11 @@ void afficher_equipe_tournoi(tournoi t);
 // Libérer le tableau des tours (fin du tournoi)
 void liberer_equipe_tournoi(tournoi t);
 
-// Supprimer et récupérer une equipe d'un tour i
-Equipe pop_equipe_at_tour(tournoi *t, int tour);
+// Vide les tours 1 et suivants pour rejouer le tournoi (placement du tour 0 gardé)
+void reinitialiser_tournoi(tournoi *t);
 
-// Génére un nom aleatoire de 3 caractére 
-char* generer_nom_equipe();
+// Récupérer l'equipe d'une place d'un tour i
+Equipe pop_equipe_at_tour(tournoi *t, int tour, int place);
 
 // Verifie si un entier une puissance de 2
 int is_power_two(int n);
@@ -80,14 +117,52 @@ int is_power_two(int n);
 int nearest_power_two(int n);
 
 // Place toutes les equipes au tour 0
-void start_tournoi(tournoi *t, Equipe e);
+void start_tournoi(tournoi *t, table_equipes *e);
+
+// Joue le tournoi mon_tournoi sur un pool de workers et attend sa fin
+void simuler_tournoi(pool *p);
+
+// Joue les tours [debut, fin) d'un sous arbre du tournoi (nbr sous arbres au tour fin)
+void simuler_tours(pool *p, int debut, int fin, int num_bloc, int nbr);
+
+// Numéro d'un match dans l'arbre (sert aussi de flux aléatoire)
+int id_match(int tour, int num_match);
+
+// Simule un match et renvoie l'equipe gagnante
+Equipe simuler_match(Equipe e1, Equipe e2, int tour, int num_match);
+
+// Coup d'envoi d'un match : prépare son état sans jouer d'action
+void partie_debut(partie *p, Equipe e1, Equipe e2, int tour, int num_match);
+
+// Joue l'action suivante d'un match et renvoie sa durée simulée (micro seconde)
+int partie_action(partie *p);
+
+// Fin d'un match dont toutes les actions sont jouées : renvoie l'equipe gagnante
+Equipe partie_fin(partie *p);
+
+// Note le resultat d'un match et le tour atteint par ses deux equipes
+void noter_resultat(int tour, int num_match, Equipe eg, Equipe ep, int score_e1, int score_e2, int drapeaux);
+
+// Qualifie le gagnant d'un match et renvoie le match suivant s'il devient jouable
+match *qualifier(match *m, Equipe e1, Equipe e2, Equipe eg, uint64_t fin);
+
+// Construit l'arbre des matchs à partir des equipes du tour 0
+void construire_arbre(tournoi *t);
+
+// Soumet les matchs d'un tour au pool de workers
+void simuler_tour(int tour);
 
-void *simuler_tournoi(void *arg);
+// Tache du pool : joue un match et qualifie le gagnant dans le match suivant
+void thread_function_match(void* arg);
 
-Equipe simuler_match(Equipe e1, Equipe e2,int tour);
+// Rejoue les matchs en aval d'une place modifiée d'un tournoi joué (au plus nbr_tours)
+int resimuler_depuis(int tour, int place);
 
-void* thread_function_match(void* arg);
+// Et si : l'autre equipe gagne ce match ; renvoie le nombre de matchs rejoués (-1 si impossible)
+int renverser_match(int tour, int num_match);
 
-void print_val_of_sem_tour(sem_t *sem, char* nom);
+// Et si : une equipe échange sa place du tour 0 avec cette place ; renvoie le nombre de matchs rejoués (-1 si impossible)
+int remplacer_equipe(int place, Equipe e);
 
-void toggle(int* state);
\ No newline at end of file
+// Parcours d'une equipe dans le tableau (au plus nbr_tours étapes) ; renvoie le nombre d'étapes
+int parcours(Equipe e, etape *etapes);
\ No newline at end of file
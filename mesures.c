@@ -0,0 +1,262 @@
+/**
+ * @file mesures.c
+ * @author Ferhat BEZTOUT
+ * @brief Histogrammes de latence par thread et par tour (attente dans la file,
+ * attente de verrou, durée des matchs)
+ * @version 1.0
+ * @date 2023-04-02
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdatomic.h>
+#include <time.h>
+
+#include "mesures.h"
+
+/* Histogrammes d'un thread : seul ce thread les écrit, le résumé les lit */
+typedef struct histogrammes {
+    atomic_uint_fast64_t cases[NBR_MESURES][MESURES_TOURS][MESURES_CASES];
+    atomic_uint_fast64_t max[NBR_MESURES][MESURES_TOURS];
+    struct histogrammes *suivant;
+} histogrammes;
+
+static _Atomic(histogrammes *) tous = NULL;
+static _Thread_local histogrammes *mes_histogrammes = NULL;
+static int actives = 0;
+
+static pthread_mutex_t verrou_resume = PTHREAD_MUTEX_INITIALIZER;
+
+static const char *noms_mesures[NBR_MESURES] = {"attente_file", "attente_verrou", "duree_match"};
+
+
+/**
+ * @brief Date courante de l'horloge monotone en nanosecondes
+ *
+ * @return uint64_t
+ */
+uint64_t mesures_maintenant(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+/**
+ * @brief case d'une durée : puissance de 2, puis MESURES_SOUS_CASES cases linéaires
+ *
+ * @param ns la durée
+ * @return int
+ */
+static int case_de(uint64_t ns)
+{
+    if (ns < MESURES_SOUS_CASES)
+    {
+        return (int)ns;
+    }
+    int p = 63 - __builtin_clzll(ns);   // ns >= 2^p
+    int sous = (int)((ns >> (p - 2)) & (MESURES_SOUS_CASES - 1));
+    return p * MESURES_SOUS_CASES + sous;
+}
+
+/**
+ * @brief borne haute (en ns) des durées rangées dans une case
+ *
+ * @param c la case
+ * @return uint64_t
+ */
+static uint64_t borne_de(int c)
+{
+    if (c < MESURES_SOUS_CASES)
+    {
+        return (uint64_t)c;
+    }
+    int p = c / MESURES_SOUS_CASES;
+    uint64_t sous = (uint64_t)(c % MESURES_SOUS_CASES);
+    return ((uint64_t)1 << p) + ((sous + 1) << (p - 2)) - 1;
+}
+
+/**
+ * @brief crée les histogrammes du thread appelant et les ajoute (sans verrou) à la liste
+ *
+ * @return histogrammes*
+ */
+static histogrammes *nouveaux_histogrammes(void)
+{
+    histogrammes *h = calloc(1, sizeof(histogrammes));
+    if (h == NULL)
+    {
+        perror("Erreur allocation memoire");
+        exit(EXIT_FAILURE);
+    }
+    h->suivant = atomic_load(&tous);
+    while (!atomic_compare_exchange_weak(&tous, &h->suivant, h))
+    {
+    }
+    return h;
+}
+
+/**
+ * @brief Ajoute une durée à l'histogramme du thread appelant. Seul le thread
+ * propriétaire écrit : chargement + écriture relâchés, sans instruction verrouillée.
+ *
+ * @param type la mesure
+ * @param tour le tour (MESURES_HORS_TOUR si aucun)
+ * @param ns la durée
+ */
+void mesure_ajouter(type_mesure type, int tour, uint64_t ns)
+{
+    if (!actives)
+    {
+        return;
+    }
+    if (mes_histogrammes == NULL)
+    {
+        mes_histogrammes = nouveaux_histogrammes();
+    }
+    if (tour < 0 || tour >= MESURES_TOURS)
+    {
+        tour = MESURES_HORS_TOUR;
+    }
+
+    atomic_uint_fast64_t *c = &mes_histogrammes->cases[type][tour][case_de(ns)];
+    atomic_store_explicit(c, atomic_load_explicit(c, memory_order_relaxed) + 1, memory_order_relaxed);
+    atomic_uint_fast64_t *m = &mes_histogrammes->max[type][tour];
+    if (ns > atomic_load_explicit(m, memory_order_relaxed))
+    {
+        atomic_store_explicit(m, ns, memory_order_relaxed);
+    }
+}
+
+/**
+ * @brief borne haute de la case contenant le quantile q
+ *
+ * @param cases histogramme fusionné
+ * @param total nombre de mesures
+ * @param q quantile (0.5, 0.99)
+ * @return uint64_t
+ */
+static uint64_t quantile(const uint64_t *cases, uint64_t total, double q)
+{
+    uint64_t rang = (uint64_t)(q * (total - 1)) + 1;
+    uint64_t cumul = 0;
+    for (int c = 0; c < MESURES_CASES; c++)
+    {
+        cumul += cases[c];
+        if (cumul >= rang)
+        {
+            return borne_de(c);
+        }
+    }
+    return borne_de(MESURES_CASES - 1);
+}
+
+/**
+ * @brief Affiche, pour chaque mesure et chaque tour, le nombre de mesures,
+ * p50, p99 et max (en micro secondes), en fusionnant les histogrammes des threads.
+ * Le thread de SIGUSR1 et main peuvent l'appeler en même temps : un résumé à la fois.
+ *
+ * @param f le fichier de sortie
+ */
+void mesures_resume(FILE *f)
+{
+    uint64_t cases[MESURES_CASES];
+
+    pthread_mutex_lock(&verrou_resume);
+    fprintf(f, "=======Mesures (us)=======\n");
+    fprintf(f, "%-15s %5s %10s %10s %10s %10s\n", "mesure", "tour", "nombre", "p50", "p99", "max");
+    for (int type = 0; type < NBR_MESURES; type++)
+    {
+        for (int tour = 0; tour < MESURES_TOURS; tour++)
+        {
+            uint64_t total = 0, max = 0;
+            memset(cases, 0, sizeof(cases));
+            for (histogrammes *h = atomic_load(&tous); h != NULL; h = h->suivant)
+            {
+                for (int c = 0; c < MESURES_CASES; c++)
+                {
+                    uint64_t n = atomic_load_explicit(&h->cases[type][tour][c], memory_order_relaxed);
+                    cases[c] += n;
+                    total += n;
+                }
+                uint64_t m = atomic_load_explicit(&h->max[type][tour], memory_order_relaxed);
+                max = (m > max) ? m : max;
+            }
+            if (total == 0)
+            {
+                continue;
+            }
+            char nom_tour[12];
+            if (tour == MESURES_HORS_TOUR)
+            {
+                strcpy(nom_tour, "-");
+            }
+            else
+            {
+                snprintf(nom_tour, sizeof(nom_tour), "%d", tour);
+            }
+            // La borne d'une case peut dépasser le max réellement observé
+            uint64_t p50 = quantile(cases, total, 0.5), p99 = quantile(cases, total, 0.99);
+            p50 = (p50 > max) ? max : p50;
+            p99 = (p99 > max) ? max : p99;
+            fprintf(f, "%-15s %5s %10llu %10.1f %10.1f %10.1f\n", noms_mesures[type], nom_tour,
+                    (unsigned long long)total, p50 / 1e3, p99 / 1e3, max / 1e3);
+        }
+    }
+    fflush(f);
+    pthread_mutex_unlock(&verrou_resume);
+}
+
+/**
+ * @brief thread qui attend SIGUSR1 et affiche alors le résumé courant
+ *
+ * @param arg inutilisé
+ * @return void*
+ */
+static void *thread_signal(void *arg)
+{
+    sigset_t *signaux = (sigset_t *)arg;
+    int sig;
+    while (sigwait(signaux, &sig) == 0)
+    {
+        mesures_resume(stderr);
+    }
+    return NULL;
+}
+
+/**
+ * @brief Active les mesures. SIGUSR1 est bloqué dans le thread appelant (et
+ * donc dans les threads créés ensuite) et traité par un thread dédié.
+ * A appeler avant de créer les workers.
+ */
+void mesures_activer(void)
+{
+    static sigset_t signaux;
+    pthread_t t;
+
+    actives = 1;
+    sigemptyset(&signaux);
+    sigaddset(&signaux, SIGUSR1);
+    pthread_sigmask(SIG_BLOCK, &signaux, NULL);
+    if (pthread_create(&t, NULL, thread_signal, &signaux) != 0)
+    {
+        perror("Erreur lors de creation thread mesures");
+        return;
+    }
+    pthread_detach(t);
+}
+
+/**
+ * @brief Renvoie 1 si les mesures sont actives
+ *
+ * @return int
+ */
+int mesures_actives(void)
+{
+    return actives;
+}
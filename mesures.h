@@ -0,0 +1,40 @@
+/* mesures.h */
+#ifndef MESURES_H
+#define MESURES_H
+
+#include <stdint.h>
+#include <stdio.h>
+
+/* Définitions des constantes */
+#define MESURES_TOURS 33            // tours suivis (le dernier regroupe les mesures hors tour)
+#define MESURES_HORS_TOUR (MESURES_TOURS - 1)
+#define MESURES_SOUS_CASES 4        // cases par puissance de 2 (précision ~19 %)
+#define MESURES_CASES (64 * MESURES_SOUS_CASES)
+
+/* Structures de données */
+
+typedef enum {
+    MESURE_ATTENTE_FILE,    // du moment où le match est jouable à son début
+    MESURE_ATTENTE_VERROU,  // attente du verrou de la file du pool
+    MESURE_DUREE_MATCH,     // durée de simuler_match
+    NBR_MESURES
+} type_mesure;
+
+
+/* ============================ Prototypes ============================ */
+// Active les mesures ; un SIGUSR1 affiche alors le résumé courant sur stderr
+void mesures_activer(void);
+
+// Renvoie 1 si les mesures sont actives
+int mesures_actives(void);
+
+// Date courante de l'horloge monotone en nanosecondes
+uint64_t mesures_maintenant(void);
+
+// Ajoute une durée à l'histogramme du thread appelant (sans verrou)
+void mesure_ajouter(type_mesure type, int tour, uint64_t ns);
+
+// Affiche nombre, p50, p99 et max de chaque mesure pour chaque tour
+void mesures_resume(FILE *f);
+
+#endif
@@ -0,0 +1,49 @@
+/**
+ * @file modele.c
+ * @author Ferhat BEZTOUT
+ * @brief Modéle de match par notes (Elo) : probabilité pré-calculée pour
+ * chaque écart de notes
+ * @version 1.0
+ * @date 2023-04-02
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+#include <math.h>
+#include <stdint.h>
+
+#include "modele.h"
+
+// modele_seuils[ecart + MODELE_ECART_MAX] : probabilité Elo de e1 sur 2^32, pour un écart entier
+uint32_t modele_seuils[2 * MODELE_ECART_MAX + 1];
+
+
+/**
+ * @brief remplit la table des seuils au chargement du programme (avant tout thread)
+ */
+__attribute__((constructor)) static void construire_seuils(void)
+{
+    for (int ecart = -MODELE_ECART_MAX; ecart <= MODELE_ECART_MAX; ecart++)
+    {
+        double p = 1.0 / (1.0 + pow(10.0, -ecart / 400.0));
+        modele_seuils[ecart + MODELE_ECART_MAX] = (uint32_t)llround(p * 4294967296.0);
+    }
+    modele_seuils[MODELE_ECART_MAX] = MODELE_EGALITE;
+}
+
+/**
+ * @brief Seuil de e1 contre e2 : probabilité Elo 1 / (1 + 10^((n2 - n1) / 400))
+ * que e1 gagne une action décisive (quel côté marque un but, vainqueur aux
+ * penalties), sur 32 bits. L'écart est borné à MODELE_ECART_MAX : un accés à
+ * une table de quelques Ko, sans calcul flottant.
+ * A notes égales le seuil vaut 2^31, soit exactement l'ancien tirage 50/50.
+ *
+ * @param t la table des equipes
+ * @param e1 premiére equipe
+ * @param e2 seconde equipe
+ * @return uint32_t
+ */
+uint32_t modele_seuil(const table_equipes *t, Equipe e1, Equipe e2)
+{
+    return modele_seuil_ecart(t->tab[e1].note - t->tab[e2].note);
+}
@@ -0,0 +1,31 @@
+/* modele.h */
+#ifndef MODELE_H
+#define MODELE_H
+
+#include <stdint.h>
+
+#include "equipes.h"
+
+/* Définitions des constantes */
+#define MODELE_NOTE_DEFAUT 1500       // note d'une equipe sans note (toutes égales : 50/50)
+#define MODELE_ECART_MAX 800        // écart de notes au-delà duquel la probabilité ne bouge plus
+#define MODELE_EGALITE 0x80000000u  // seuil d'un match entre deux equipes de même note
+
+
+// Seuils pré-calculés : modele_seuils[ecart + MODELE_ECART_MAX] (modele.c)
+extern uint32_t modele_seuils[2 * MODELE_ECART_MAX + 1];
+
+
+/* ============================ Prototypes ============================ */
+// Seuil pour un écart de notes (borné à MODELE_ECART_MAX), inliné dans les boucles de match
+static inline uint32_t modele_seuil_ecart(int ecart)
+{
+    ecart = (ecart > MODELE_ECART_MAX) ? MODELE_ECART_MAX : ecart;
+    ecart = (ecart < -MODELE_ECART_MAX) ? -MODELE_ECART_MAX : ecart;
+    return modele_seuils[ecart + MODELE_ECART_MAX];
+}
+
+// Seuil sur 32 bits : une action décisive (but, penalties) est pour e1 si un tirage 32 bits est < seuil
+uint32_t modele_seuil(const table_equipes *t, Equipe e1, Equipe e2);
+
+#endif
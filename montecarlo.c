@@ -0,0 +1,284 @@
+/**
+ * @file montecarlo.c
+ * @author Ferhat BEZTOUT
+ * @brief Simulation en lot : N tournois indépendants, probabilités par equipe
+ * @version 1.0
+ * @date 2023-04-02
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "main.h"
+#include "montecarlo.h"
+#include "noyau.h"
+#include "modele.h"
+
+/* Un lot de tournois joués par une tache du pool, avec ses propres tampons */
+typedef struct {
+    const Equipe *placement;    // equipes du tour 0 (-1 : place vide, adversaire exempté)
+    const table_equipes *equipes;   // notes des equipes (NULL : toutes égales)
+    int nbr_equipes;
+    int nbr_tours;
+    long premier;           // numéro du premier tournoi du lot
+    long nbr;               // nombre de tournois du lot
+    uint64_t graine;
+    uint64_t *atteint;      // compteurs privés du lot (fusionnés à la fin)
+} lot;
+
+
+/**
+ * @brief joue les tournois d'un lot, NOYAU_VOIES à la fois (une voie du noyau
+ * par tournoi). Chaque tour de ces tournois est joué en un seul appel au
+ * noyau. Les tableaux des equipes encore en lice sont réutilisés d'un tournoi
+ * à l'autre et d'un tour à l'autre (le gagnant du match i prend la place i) ;
+ * ils sont rangés [place * NOYAU_VOIES + voie]. Toujours inlinée : appelée
+ * avec un nbr_tours constant, tailles et bornes de boucle deviennent des
+ * constantes (voir LOT_FIXE).
+ *
+ * @param l le lot
+ * @param nbr_tours nombre de tours
+ * @param en_lice tampon de (1 << nbr_tours) * NOYAU_VOIES equipes
+ * @param gagnant tampon de (1 << nbr_tours) / 2 * NOYAU_VOIES résultats
+ * @param seuil tampon de (1 << nbr_tours) / 2 * NOYAU_VOIES seuils (inutilisé à notes égales)
+ */
+static inline __attribute__((always_inline)) void jouer_tournois(lot *l, int nbr_tours, Equipe *en_lice, uint8_t *gagnant, uint32_t *seuil)
+{
+    const int n = 1 << nbr_tours;
+
+    for (long k = 0; k < l->nbr; k += NOYAU_VOIES)
+    {
+        // Les voies au-delà du lot sont jouées mais pas comptées
+        int voies = (l->nbr - k < NOYAU_VOIES) ? (int)(l->nbr - k) : NOYAU_VOIES;
+        noyau_alea g;
+        noyau_init(&g, l->graine, (uint64_t)(l->premier + k));
+        for (int i = 0; i < n; i++)
+        {
+            for (int v = 0; v < NOYAU_VOIES; v++)
+            {
+                en_lice[i * NOYAU_VOIES + v] = l->placement[i];
+            }
+        }
+
+        // Déroulée entiérement quand nbr_tours est constant (LOT_FIXE_MAX tours au plus)
+#pragma GCC unroll 8
+        for (int tour = 1; tour <= nbr_tours; tour++)
+        {
+            uint64_t *atteint = l->atteint + (size_t)tour * n;
+            int taille = n >> tour;
+            if (l->equipes != NULL)
+            {
+                // Seuil de chaque match d'aprés les notes (une lecture de table par match)
+                const struct equipe *tab = l->equipes->tab;
+                for (int i = 0; i < taille; i++)
+                {
+                    for (int v = 0; v < NOYAU_VOIES; v++)
+                    {
+                        Equipe e1 = en_lice[(2 * i) * NOYAU_VOIES + v];
+                        Equipe e2 = en_lice[(2 * i + 1) * NOYAU_VOIES + v];
+                        seuil[i * NOYAU_VOIES + v] = (e1 < 0 || e2 < 0) ? MODELE_EGALITE
+                                                                         : modele_seuil_ecart(tab[e1].note - tab[e2].note);
+                    }
+                }
+            }
+            noyau_tour(&g, taille, (l->equipes != NULL) ? seuil : NULL, gagnant, NULL, NULL);
+            for (int i = 0; i < taille; i++)
+            {
+                for (int v = 0; v < NOYAU_VOIES; v++)
+                {
+                    int place = 2 * i + gagnant[i * NOYAU_VOIES + v];
+                    Equipe eg = en_lice[place * NOYAU_VOIES + v];
+                    if (eg < 0)
+                    {
+                        eg = en_lice[(place ^ 1) * NOYAU_VOIES + v]; // exempt : l'adversaire passe
+                    }
+                    en_lice[i * NOYAU_VOIES + v] = eg;
+                    if (v < voies)
+                    {
+                        atteint[eg]++;
+                    }
+                }
+            }
+        }
+    }
+}
+
+/**
+ * @brief Tache du pool : joue les tournois d'un lot, quelle que soit leur taille
+ *
+ * @param arg le lot
+ */
+static void jouer_lot(void *arg)
+{
+    lot *l = (lot *)arg;
+    int n = l->nbr_equipes;
+    Equipe *en_lice = malloc((size_t)n * NOYAU_VOIES * sizeof(Equipe));
+    uint8_t *gagnant = malloc((size_t)(n / 2) * NOYAU_VOIES);
+    uint32_t *seuil = malloc((size_t)(n / 2) * NOYAU_VOIES * sizeof(uint32_t));
+    if (en_lice == NULL || gagnant == NULL || seuil == NULL)
+    {
+        perror("Erreur allocation memoire");
+        exit(EXIT_FAILURE);
+    }
+
+    jouer_tournois(l, l->nbr_tours, en_lice, gagnant, seuil);
+
+    free(seuil);
+    free(gagnant);
+    free(en_lice);
+}
+
+/*
+ * Taches spécialisées pour les tailles courantes (16 à 128 equipes) : le
+ * nombre de tours est une constante, les tampons sont sur la pile (aucune
+ * allocation) et les boucles des tours sont entiérement déroulées.
+ */
+#define LOT_FIXE(TOURS)                                                     \
+    static void jouer_lot_##TOURS(void *arg)                                \
+    {                                                                       \
+        Equipe en_lice[(1 << TOURS) * NOYAU_VOIES];                         \
+        uint8_t gagnant[(1 << TOURS) / 2 * NOYAU_VOIES];                    \
+        uint32_t seuil[(1 << TOURS) / 2 * NOYAU_VOIES];                     \
+        jouer_tournois((lot *)arg, TOURS, en_lice, gagnant, seuil);         \
+    }
+
+LOT_FIXE(4)
+LOT_FIXE(5)
+LOT_FIXE(6)
+LOT_FIXE(7)
+
+#define LOT_FIXE_MIN 4
+#define LOT_FIXE_MAX 7
+
+static const tache_fn lots_fixes[LOT_FIXE_MAX - LOT_FIXE_MIN + 1] = {
+    jouer_lot_4, jouer_lot_5, jouer_lot_6, jouer_lot_7};
+
+
+/**
+ * @brief Renvoie 1 si les tournois à nbr_tours tours ont une tache spécialisée
+ *
+ * @param nbr_tours nombre de tours
+ * @return int
+ */
+int montecarlo_taille_fixe(int nbr_tours)
+{
+    return nbr_tours >= LOT_FIXE_MIN && nbr_tours <= LOT_FIXE_MAX;
+}
+
+/**
+ * @brief Joue nbr_tournois tournois indépendants. Le tournoi k utilise le flux
+ * (graine, k) : le résultat ne dépend ni du nombre de workers ni du jeu
+ * d'instructions du noyau.
+ *
+ * @param p le pool de workers
+ * @param equipes la table des equipes (leurs notes)
+ * @param placement equipes du tour 0 (-1 pour une place vide)
+ * @param nbr_equipes nombre de places du tour 0 (puissance de 2)
+ * @param nbr_tours nombre de tours
+ * @param nbr_tournois nombre de tournois à jouer
+ * @param graine graine maître
+ * @return stats_montecarlo
+ */
+stats_montecarlo montecarlo(pool *p, const table_equipes *equipes, const Equipe *placement, int nbr_equipes, int nbr_tours, long nbr_tournois, uint64_t graine)
+{
+    stats_montecarlo s;
+    size_t nbr_compteurs = (size_t)(nbr_tours + 1) * nbr_equipes;
+    s.nbr_equipes = nbr_equipes;
+    s.nbr_tours = nbr_tours;
+    s.nbr_tournois = nbr_tournois;
+    s.atteint = calloc(nbr_compteurs, sizeof(uint64_t));
+
+    int nbr_lots = p->nbr_workers;
+    if (nbr_lots > nbr_tournois)
+    {
+        nbr_lots = (int)nbr_tournois;
+    }
+    lot *lots = malloc(nbr_lots * sizeof(lot));
+    noyau_isa(); // choix du chemin du noyau avant de lancer les workers
+    if (s.atteint == NULL || lots == NULL)
+    {
+        perror("Erreur allocation memoire");
+        exit(EXIT_FAILURE);
+    }
+
+    long premier = 0;
+    for (int i = 0; i < nbr_lots; i++)
+    {
+        lots[i].placement = placement;
+        lots[i].equipes = equipes->notee ? equipes : NULL;    // notes égales : noyau sans seuils
+        lots[i].nbr_equipes = nbr_equipes;
+        lots[i].nbr_tours = nbr_tours;
+        lots[i].premier = premier;
+        lots[i].nbr = nbr_tournois / nbr_lots + (i < nbr_tournois % nbr_lots);
+        lots[i].graine = graine;
+        lots[i].atteint = calloc(nbr_compteurs, sizeof(uint64_t));
+        if (lots[i].atteint == NULL)
+        {
+            perror("Erreur allocation memoire");
+            exit(EXIT_FAILURE);
+        }
+        premier += lots[i].nbr;
+        pool_soumettre(p, montecarlo_taille_fixe(nbr_tours) ? lots_fixes[nbr_tours - LOT_FIXE_MIN] : jouer_lot, &lots[i]);
+    }
+    pool_attendre(p);
+
+    // Fusion des compteurs privés
+    for (int i = 0; i < nbr_lots; i++)
+    {
+        for (size_t c = 0; c < nbr_compteurs; c++)
+        {
+            s.atteint[c] += lots[i].atteint[c];
+        }
+        free(lots[i].atteint);
+    }
+    free(lots);
+
+    // Toutes les equipes sont au tour 0
+    for (int e = 0; e < nbr_equipes; e++)
+    {
+        s.atteint[e] = nbr_tournois;
+    }
+    return s;
+}
+
+/**
+ * @brief Ecrit en CSV la probabilité de chaque equipe d'atteindre chaque tour
+ * (une ligne par equipe, la derniére colonne est la probabilité de victoire)
+ *
+ * @param s les compteurs
+ * @param t la table des equipes
+ * @param f le fichier de sortie
+ */
+void afficher_montecarlo(const stats_montecarlo *s, const table_equipes *t, FILE *f)
+{
+    fprintf(f, "id,nom");
+    for (int tour = 1; tour < s->nbr_tours; tour++)
+    {
+        fprintf(f, ",tour%d", tour);
+    }
+    fprintf(f, ",vainqueur\n");
+
+    for (Equipe e = 0; e < t->nbr; e++)
+    {
+        fprintf(f, "%d,%.*s", t->tab[e].id, lg_nom_equipe(t, e), nom_equipe(t, e));
+        for (int tour = 1; tour <= s->nbr_tours; tour++)
+        {
+            fprintf(f, ",%.6f", (double)s->atteint[(size_t)tour * s->nbr_equipes + e] / s->nbr_tournois);
+        }
+        fputc('\n', f);
+    }
+}
+
+/**
+ * @brief Libére les compteurs
+ *
+ * @param s les compteurs
+ */
+void liberer_montecarlo(stats_montecarlo *s)
+{
+    free(s->atteint);
+    s->atteint = NULL;
+}
@@ -0,0 +1,34 @@
+/* montecarlo.h */
+#ifndef MONTECARLO_H
+#define MONTECARLO_H
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include "equipes.h"
+#include "pool.h"
+
+/* Structures de données */
+
+typedef struct {
+    int nbr_equipes;        // places au tour 0 (puissance de 2)
+    int nbr_tours;
+    long nbr_tournois;
+    uint64_t *atteint;      // atteint[r * nbr_equipes + e] : tournois où e a atteint le tour r (nbr_tours = vainqueur)
+} stats_montecarlo;
+
+
+/* ============================ Prototypes ============================ */
+// Joue nbr_tournois tournois indépendants en parallèle sur le pool et compte les tours atteints
+stats_montecarlo montecarlo(pool *p, const table_equipes *equipes, const Equipe *placement, int nbr_equipes, int nbr_tours, long nbr_tournois, uint64_t graine);
+
+// Renvoie 1 si les tournois de cette taille sont joués par un code spécialisé (16 à 128 equipes)
+int montecarlo_taille_fixe(int nbr_tours);
+
+// Ecrit en CSV la probabilité de chaque equipe d'atteindre chaque tour
+void afficher_montecarlo(const stats_montecarlo *s, const table_equipes *t, FILE *f);
+
+// Libére les compteurs
+void liberer_montecarlo(stats_montecarlo *s);
+
+#endif
@@ -0,0 +1,328 @@
+/**
+ * @file noyau.c
+ * @author Ferhat BEZTOUT
+ * @brief Noyau de match vectorisé : NOYAU_VOIES matchs indépendants joués de
+ * front, en AVX2, SSE2 ou en scalaire selon le processeur
+ * @version 1.0
+ * @date 2023-04-02
+ *
+ * @copyright Copyright (c) 2023
+ *
+ * Chaque voie suit exactement la même régle, quel que soit le chemin, avec
+ * le seuil s du match (modele.h, 2^31 à notes égales) :
+ *  - une action = un tirage x : but si (x >> 32) < 2^32 / 5 (1 chance sur 5),
+ *    marqué par la seconde equipe si les 32 bits bas de x sont >= s ;
+ *  - aprés DUREE_MATCH actions, un tirage p : en cas d'égalité, la seconde
+ *    equipe gagne aux penalties si (p >> 32) >= s.
+ * Les trois chemins donnent donc des résultats identiques au bit prés.
+ */
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+
+#include "main.h"
+#include "noyau.h"
+#include "alea.h"
+#include "modele.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define NOYAU_X86 1
+#endif
+
+// (x >> 32) + COMPLEMENT_BUT déborde sur le bit 32 ssi (x >> 32) >= SEUIL_BUT
+#define SEUIL_BUT 858993460ULL                  // ceil(2^32 / 5)
+#define COMPLEMENT_BUT ((1ULL << 32) - SEUIL_BUT)
+#define BAS_32 0xffffffffULL
+
+
+/**
+ * @brief Initialise les voies. La voie v a le même état que
+ * alea_init(graine, premier_flux + v).
+ *
+ * @param g les générateurs des voies
+ * @param graine graine maître
+ * @param premier_flux flux de la voie 0
+ */
+void noyau_init(noyau_alea *g, uint64_t graine, uint64_t premier_flux)
+{
+    for (int v = 0; v < NOYAU_VOIES; v++)
+    {
+        alea a;
+        alea_init(&a, graine, premier_flux + v);
+        for (int k = 0; k < 4; k++)
+        {
+            g->s[k][v] = a.s[k];
+        }
+    }
+}
+
+/**
+ * @brief seuil du match i de la voie v (MODELE_EGALITE sans table de seuils)
+ */
+static inline uint64_t seuil_match(const uint32_t *seuil, int i, int v)
+{
+    return (seuil != NULL) ? seuil[i * NOYAU_VOIES + v] : MODELE_EGALITE;
+}
+
+/**
+ * @brief range le résultat d'un match d'une voie
+ */
+static void conclure(int i, int v, uint64_t s1, uint64_t s2, uint64_t p, uint64_t seuil, uint8_t *gagnant, uint8_t *score_e1, uint8_t *score_e2)
+{
+    int k = i * NOYAU_VOIES + v;
+    gagnant[k] = (s1 != s2) ? (s2 > s1) : (uint8_t)((p >> 32) >= seuil);
+    if (score_e1 != NULL)
+    {
+        score_e1[k] = (uint8_t)s1;
+        score_e2[k] = (uint8_t)s2;
+    }
+}
+
+/* ============================ Chemin scalaire ============================ */
+
+static uint64_t rotl(uint64_t x, int k)
+{
+    return (x << k) | (x >> (64 - k));
+}
+
+static uint64_t suivant_scalaire(uint64_t *s0, uint64_t *s1, uint64_t *s2, uint64_t *s3)
+{
+    uint64_t resultat = rotl(*s1 * 5, 7) * 9;
+    uint64_t t = *s1 << 17;
+    *s2 ^= *s0;
+    *s3 ^= *s1;
+    *s1 ^= *s2;
+    *s0 ^= *s3;
+    *s2 ^= t;
+    *s3 = rotl(*s3, 45);
+    return resultat;
+}
+
+static void tour_scalaire(noyau_alea *g, int nbr_matchs, const uint32_t *seuil, uint8_t *gagnant, uint8_t *score_e1, uint8_t *score_e2)
+{
+    for (int v = 0; v < NOYAU_VOIES; v++)
+    {
+        uint64_t s0 = g->s[0][v], s1 = g->s[1][v], s2 = g->s[2][v], s3 = g->s[3][v];
+        for (int i = 0; i < nbr_matchs; i++)
+        {
+            uint64_t but1 = 0, but2 = 0;
+            uint64_t sm = seuil_match(seuil, i, v);
+            for (int temps = 0; temps < DUREE_MATCH; temps++)
+            {
+                uint64_t x = suivant_scalaire(&s0, &s1, &s2, &s3);
+                uint64_t but = 1 - ((((x >> 32) + COMPLEMENT_BUT) >> 32) & 1);
+                uint64_t cote = 1 - ((((x & BAS_32) - sm) >> 63) & 1);    // bas >= seuil
+                but1 += but & (cote ^ 1);
+                but2 += but & cote;
+            }
+            uint64_t p = suivant_scalaire(&s0, &s1, &s2, &s3);
+            conclure(i, v, but1, but2, p, sm, gagnant, score_e1, score_e2);
+        }
+        g->s[0][v] = s0;
+        g->s[1][v] = s1;
+        g->s[2][v] = s2;
+        g->s[3][v] = s3;
+    }
+}
+
+#ifdef NOYAU_X86
+/* ============================ Chemin SSE2 (2 voies par registre) ============================ */
+
+static inline __m128i rotl_sse2(__m128i x, int k)
+{
+    return _mm_or_si128(_mm_slli_epi64(x, k), _mm_srli_epi64(x, 64 - k));
+}
+
+static inline __m128i suivant_sse2(__m128i *s)
+{
+    __m128i x5 = _mm_add_epi64(s[1], _mm_slli_epi64(s[1], 2));
+    __m128i r = rotl_sse2(x5, 7);
+    __m128i resultat = _mm_add_epi64(r, _mm_slli_epi64(r, 3));
+    __m128i t = _mm_slli_epi64(s[1], 17);
+    s[2] = _mm_xor_si128(s[2], s[0]);
+    s[3] = _mm_xor_si128(s[3], s[1]);
+    s[1] = _mm_xor_si128(s[1], s[2]);
+    s[0] = _mm_xor_si128(s[0], s[3]);
+    s[2] = _mm_xor_si128(s[2], t);
+    s[3] = rotl_sse2(s[3], 45);
+    return resultat;
+}
+
+static void tour_sse2(noyau_alea *g, int nbr_matchs, const uint32_t *seuil, uint8_t *gagnant, uint8_t *score_e1, uint8_t *score_e2)
+{
+    const __m128i un = _mm_set1_epi64x(1);
+    const __m128i complement = _mm_set1_epi64x(COMPLEMENT_BUT);
+    const __m128i bas = _mm_set1_epi64x(BAS_32);
+
+    for (int v = 0; v < NOYAU_VOIES; v += 2)
+    {
+        __m128i s[4];
+        for (int k = 0; k < 4; k++)
+        {
+            s[k] = _mm_loadu_si128((const __m128i *)&g->s[k][v]);
+        }
+        for (int i = 0; i < nbr_matchs; i++)
+        {
+            __m128i but1 = _mm_setzero_si128(), but2 = _mm_setzero_si128();
+            __m128i sm = _mm_set_epi64x(seuil_match(seuil, i, v + 1), seuil_match(seuil, i, v));
+            for (int temps = 0; temps < DUREE_MATCH; temps++)
+            {
+                __m128i x = suivant_sse2(s);
+                __m128i d = _mm_add_epi64(_mm_srli_epi64(x, 32), complement);
+                __m128i but = _mm_xor_si128(_mm_and_si128(_mm_srli_epi64(d, 32), un), un);
+                __m128i c = _mm_sub_epi64(_mm_and_si128(x, bas), sm);
+                __m128i cote = _mm_xor_si128(_mm_srli_epi64(c, 63), un);   // bas >= seuil
+                but1 = _mm_add_epi64(but1, _mm_andnot_si128(cote, but));
+                but2 = _mm_add_epi64(but2, _mm_and_si128(cote, but));
+            }
+            __m128i p = suivant_sse2(s);
+
+            uint64_t b1[2], b2[2], pp[2];
+            _mm_storeu_si128((__m128i *)b1, but1);
+            _mm_storeu_si128((__m128i *)b2, but2);
+            _mm_storeu_si128((__m128i *)pp, p);
+            for (int w = 0; w < 2; w++)
+            {
+                conclure(i, v + w, b1[w], b2[w], pp[w], seuil_match(seuil, i, v + w), gagnant, score_e1, score_e2);
+            }
+        }
+        for (int k = 0; k < 4; k++)
+        {
+            _mm_storeu_si128((__m128i *)&g->s[k][v], s[k]);
+        }
+    }
+}
+
+/* ============================ Chemin AVX2 (4 voies par registre) ============================ */
+
+__attribute__((target("avx2"))) static inline __m256i rotl_avx2(__m256i x, int k)
+{
+    return _mm256_or_si256(_mm256_slli_epi64(x, k), _mm256_srli_epi64(x, 64 - k));
+}
+
+__attribute__((target("avx2"))) static inline __m256i suivant_avx2(__m256i *s)
+{
+    __m256i x5 = _mm256_add_epi64(s[1], _mm256_slli_epi64(s[1], 2));
+    __m256i r = rotl_avx2(x5, 7);
+    __m256i resultat = _mm256_add_epi64(r, _mm256_slli_epi64(r, 3));
+    __m256i t = _mm256_slli_epi64(s[1], 17);
+    s[2] = _mm256_xor_si256(s[2], s[0]);
+    s[3] = _mm256_xor_si256(s[3], s[1]);
+    s[1] = _mm256_xor_si256(s[1], s[2]);
+    s[0] = _mm256_xor_si256(s[0], s[3]);
+    s[2] = _mm256_xor_si256(s[2], t);
+    s[3] = rotl_avx2(s[3], 45);
+    return resultat;
+}
+
+__attribute__((target("avx2"))) static void tour_avx2(noyau_alea *g, int nbr_matchs, const uint32_t *seuil, uint8_t *gagnant, uint8_t *score_e1, uint8_t *score_e2)
+{
+    const __m256i un = _mm256_set1_epi64x(1);
+    const __m256i complement = _mm256_set1_epi64x(COMPLEMENT_BUT);
+    const __m256i bas = _mm256_set1_epi64x(BAS_32);
+    const __m256i egalite = _mm256_set1_epi64x(MODELE_EGALITE);
+
+    for (int v = 0; v < NOYAU_VOIES; v += 4)
+    {
+        __m256i s[4];
+        for (int k = 0; k < 4; k++)
+        {
+            s[k] = _mm256_loadu_si256((const __m256i *)&g->s[k][v]);
+        }
+        for (int i = 0; i < nbr_matchs; i++)
+        {
+            __m256i but1 = _mm256_setzero_si256(), but2 = _mm256_setzero_si256();
+            __m256i sm = (seuil != NULL)
+                             ? _mm256_cvtepu32_epi64(_mm_loadu_si128((const __m128i *)&seuil[i * NOYAU_VOIES + v]))
+                             : egalite;
+            for (int temps = 0; temps < DUREE_MATCH; temps++)
+            {
+                __m256i x = suivant_avx2(s);
+                __m256i d = _mm256_add_epi64(_mm256_srli_epi64(x, 32), complement);
+                __m256i but = _mm256_xor_si256(_mm256_and_si256(_mm256_srli_epi64(d, 32), un), un);
+                __m256i c = _mm256_sub_epi64(_mm256_and_si256(x, bas), sm);
+                __m256i cote = _mm256_xor_si256(_mm256_srli_epi64(c, 63), un);   // bas >= seuil
+                but1 = _mm256_add_epi64(but1, _mm256_andnot_si256(cote, but));
+                but2 = _mm256_add_epi64(but2, _mm256_and_si256(cote, but));
+            }
+            __m256i p = suivant_avx2(s);
+
+            uint64_t b1[4], b2[4], pp[4];
+            _mm256_storeu_si256((__m256i *)b1, but1);
+            _mm256_storeu_si256((__m256i *)b2, but2);
+            _mm256_storeu_si256((__m256i *)pp, p);
+            for (int w = 0; w < 4; w++)
+            {
+                conclure(i, v + w, b1[w], b2[w], pp[w], seuil_match(seuil, i, v + w), gagnant, score_e1, score_e2);
+            }
+        }
+        for (int k = 0; k < 4; k++)
+        {
+            _mm256_storeu_si256((__m256i *)&g->s[k][v], s[k]);
+        }
+    }
+}
+#endif
+
+/* ============================ Aiguillage ============================ */
+
+typedef void (*fonction_tour)(noyau_alea *, int, const uint32_t *, uint8_t *, uint8_t *, uint8_t *);
+
+static fonction_tour tour_choisi = NULL;
+static const char *isa_choisi = "scalaire";
+static pthread_once_t chemin_choisi = PTHREAD_ONCE_INIT;    // les workers appellent noyau_tour en parallèle
+
+/**
+ * @brief choisit le chemin le plus rapide disponible. La variable
+ * d'environnement NOYAU_ISA (avx2, sse2, scalaire) permet de forcer un chemin.
+ */
+static void choisir_chemin(void)
+{
+    const char *force = getenv("NOYAU_ISA");
+    tour_choisi = tour_scalaire;
+    isa_choisi = "scalaire";
+#ifdef NOYAU_X86
+    __builtin_cpu_init();
+    if (force == NULL || strcmp(force, "scalaire") != 0)
+    {
+        tour_choisi = tour_sse2;
+        isa_choisi = "sse2";
+        if ((force == NULL || strcmp(force, "avx2") == 0) && __builtin_cpu_supports("avx2"))
+        {
+            tour_choisi = tour_avx2;
+            isa_choisi = "avx2";
+        }
+    }
+#else
+    (void)force;
+#endif
+}
+
+/**
+ * @brief Joue nbr_matchs matchs successifs dans chaque voie, en gardant l'état
+ * des générateurs dans les registres pendant tout le tour.
+ *
+ * @param g les générateurs des voies
+ * @param nbr_matchs nombre de matchs par voie
+ * @param seuil seuil[i * NOYAU_VOIES + v] du match (modele_seuil), NULL si toutes les notes sont égales
+ * @param gagnant gagnant[i * NOYAU_VOIES + v] : 0 si la premiére equipe gagne, 1 sinon
+ * @param score_e1 score de la premiére equipe (NULL si inutile)
+ * @param score_e2 score de la seconde equipe (NULL si inutile)
+ */
+void noyau_tour(noyau_alea *g, int nbr_matchs, const uint32_t *seuil, uint8_t *gagnant, uint8_t *score_e1, uint8_t *score_e2)
+{
+    pthread_once(&chemin_choisi, choisir_chemin);
+    tour_choisi(g, nbr_matchs, seuil, gagnant, score_e1, score_e2);
+}
+
+/**
+ * @brief Nom du jeu d'instructions utilisé
+ *
+ * @return const char*
+ */
+const char *noyau_isa(void)
+{
+    pthread_once(&chemin_choisi, choisir_chemin);
+    return isa_choisi;
+}
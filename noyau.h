@@ -0,0 +1,29 @@
+/* noyau.h */
+#ifndef NOYAU_H
+#define NOYAU_H
+
+#include <stdint.h>
+
+/* Définitions des constantes */
+#define NOYAU_VOIES 8   // matchs joués de front (un flux aléatoire par voie)
+
+/* Structures de données */
+
+// Etat xoshiro256** de chaque voie, rangé par colonne : s[k][voie]
+typedef struct {
+    uint64_t s[4][NOYAU_VOIES];
+} noyau_alea;
+
+
+/* ============================ Prototypes ============================ */
+// Initialise les voies : la voie v reçoit le flux (graine, premier_flux + v)
+void noyau_init(noyau_alea *g, uint64_t graine, uint64_t premier_flux);
+
+// Joue nbr_matchs matchs dans chaque voie (seuils des notes, NULL à notes égales) ;
+// résultats rangés [match * NOYAU_VOIES + voie]
+void noyau_tour(noyau_alea *g, int nbr_matchs, const uint32_t *seuil, uint8_t *gagnant, uint8_t *score_e1, uint8_t *score_e2);
+
+// Nom du jeu d'instructions utilisé (avx2, sse2 ou scalaire)
+const char *noyau_isa(void);
+
+#endif
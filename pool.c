@@ -0,0 +1,267 @@
+/**
+ * @file pool.c
+ * @author Ferhat BEZTOUT
+ * @brief Pool de threads de taille fixe avec une file de taches prêtes
+ * @version 1.0
+ * @date 2023-04-02
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <pthread.h>
+#include <unistd.h>
+
+#include "pool.h"
+#include "mesures.h"
+
+
+/**
+ * @brief Renvoie le nombre de coeurs disponibles
+ *
+ * @return int
+ */
+int pool_nbr_coeurs(void)
+{
+    long n = sysconf(_SC_NPROCESSORS_ONLN);
+    if (n < 1)
+    {
+        return 1;
+    }
+    return (int)n;
+}
+
+/**
+ * @brief prend le verrou du pool ; si il est déjà pris et que les mesures sont
+ * actives, l'attente est mesurée (aucune lecture d'horloge sans contention).
+ * L'appelant l'ajoute au tour de la tache mise dans la file ou retirée.
+ *
+ * @param p le pool
+ * @return uint64_t l'attente en nanosecondes, 0 si elle n'est pas mesurée
+ */
+static uint64_t verrouiller(pool *p)
+{
+    if (pthread_mutex_trylock(&p->verrou) == 0)
+    {
+        return 0;
+    }
+    if (!mesures_actives())
+    {
+        pthread_mutex_lock(&p->verrou);
+        return 0;
+    }
+    uint64_t debut = mesures_maintenant();
+    pthread_mutex_lock(&p->verrou);
+    return mesures_maintenant() - debut;
+}
+
+/**
+ * @brief boucle d'un worker : récupére une tache prête et l'execute
+ *
+ * @param arg le pool
+ * @return void*
+ */
+static void *worker(void *arg)
+{
+    pool *p = (pool *)arg;
+
+    // Attente du verrou, comptée au tour de la tache retirée ensuite
+    uint64_t attente = verrouiller(p);
+    while (1)
+    {
+        while (p->taille == 0 && !p->arret)
+        {
+            pthread_cond_wait(&p->tache_dispo, &p->verrou);
+        }
+        if (p->taille == 0 && p->arret)
+        {
+            break;
+        }
+
+        // debut_SC
+        tache t = p->file[p->tete];
+        p->tete = (p->tete + 1) % p->capacite;
+        p->taille--;
+        // fin_SC
+        pthread_mutex_unlock(&p->verrou);
+
+        if (attente > 0)
+        {
+            mesure_ajouter(MESURE_ATTENTE_VERROU, t.tour, attente);
+        }
+        t.fn(t.arg);
+
+        attente = verrouiller(p);
+        p->en_cours--;
+        if (p->en_cours == 0)
+        {
+            pthread_cond_broadcast(&p->tout_fini);
+        }
+    }
+    pthread_mutex_unlock(&p->verrou);
+    if (attente > 0)
+    {
+        mesure_ajouter(MESURE_ATTENTE_VERROU, MESURES_HORS_TOUR, attente);
+    }
+
+    return NULL;
+}
+
+/**
+ * @brief Crée un pool de threads de taille fixe
+ *
+ * @param nbr_workers nombre de threads (0 = un par coeur)
+ * @return pool*
+ */
+pool *pool_creer(int nbr_workers)
+{
+    if (nbr_workers <= 0)
+    {
+        nbr_workers = pool_nbr_coeurs();
+    }
+
+    pool *p = malloc(sizeof(pool));
+    if (p == NULL)
+    {
+        perror("Erreur allocation memoire");
+        exit(EXIT_FAILURE);
+    }
+
+    p->nbr_workers = nbr_workers;
+    p->capacite = 64;
+    p->tete = 0;
+    p->taille = 0;
+    p->en_cours = 0;
+    p->arret = 0;
+    p->file = malloc(p->capacite * sizeof(tache));
+    p->workers = malloc(nbr_workers * sizeof(pthread_t));
+    if (p->file == NULL || p->workers == NULL)
+    {
+        perror("Erreur allocation memoire");
+        exit(EXIT_FAILURE);
+    }
+
+    pthread_mutex_init(&p->verrou, NULL);
+    pthread_cond_init(&p->tache_dispo, NULL);
+    pthread_cond_init(&p->tout_fini, NULL);
+
+    for (int i = 0; i < nbr_workers; i++)
+    {
+        if (pthread_create(&p->workers[i], NULL, worker, p) != 0)
+        {
+            perror("Erreur lors de creation thread worker");
+            exit(EXIT_FAILURE);
+        }
+    }
+    return p;
+}
+
+/**
+ * @brief double la capacité de la file (appelée sous le verrou)
+ *
+ * @param p le pool
+ */
+static void agrandir_file(pool *p)
+{
+    int capacite = p->capacite * 2;
+    tache *file = malloc(capacite * sizeof(tache));
+    if (file == NULL)
+    {
+        perror("Erreur allocation memoire");
+        exit(EXIT_FAILURE);
+    }
+    for (int i = 0; i < p->taille; i++)
+    {
+        file[i] = p->file[(p->tete + i) % p->capacite];
+    }
+    free(p->file);
+    p->file = file;
+    p->capacite = capacite;
+    p->tete = 0;
+}
+
+/**
+ * @brief Ajoute une tache prête à la file du pool, en comptant l'attente du
+ * verrou (et celle du worker qui la retirera) dans les mesures du tour tour
+ *
+ * @param p le pool
+ * @param fn la fonction à executer
+ * @param arg argument passé à fn
+ * @param tour tour du match (mesures.h), MESURES_HORS_TOUR pour une autre tache
+ */
+void pool_soumettre_tour(pool *p, tache_fn fn, void *arg, int tour)
+{
+    uint64_t attente = verrouiller(p);
+    if (p->taille == p->capacite)
+    {
+        agrandir_file(p);
+    }
+    p->file[(p->tete + p->taille) % p->capacite] = (tache){fn, arg, tour};
+    p->taille++;
+    p->en_cours++;
+    pthread_cond_signal(&p->tache_dispo);
+    pthread_mutex_unlock(&p->verrou);
+    if (attente > 0)
+    {
+        mesure_ajouter(MESURE_ATTENTE_VERROU, tour, attente);
+    }
+}
+
+/**
+ * @brief Ajoute une tache prête à la file du pool (hors des tours du tournoi)
+ *
+ * @param p le pool
+ * @param fn la fonction à executer
+ * @param arg argument passé à fn
+ */
+void pool_soumettre(pool *p, tache_fn fn, void *arg)
+{
+    pool_soumettre_tour(p, fn, arg, MESURES_HORS_TOUR);
+}
+
+/**
+ * @brief Attend que toutes les taches soumises soient terminées
+ *
+ * Une tache peut en soumettre d'autres : le compteur en_cours ne tombe à 0
+ * qu'une fois la derniére tache de la chaîne terminée.
+ *
+ * @param p le pool
+ */
+void pool_attendre(pool *p)
+{
+    pthread_mutex_lock(&p->verrou);
+    while (p->en_cours > 0)
+    {
+        pthread_cond_wait(&p->tout_fini, &p->verrou);
+    }
+    pthread_mutex_unlock(&p->verrou);
+}
+
+/**
+ * @brief Arrête les workers (après avoir vidé la file) et libére le pool
+ *
+ * @param p le pool
+ */
+void pool_detruire(pool *p)
+{
+    pthread_mutex_lock(&p->verrou);
+    p->arret = 1;
+    pthread_cond_broadcast(&p->tache_dispo);
+    pthread_mutex_unlock(&p->verrou);
+
+    for (int i = 0; i < p->nbr_workers; i++)
+    {
+        if (pthread_join(p->workers[i], NULL) != 0)
+        {
+            perror("Erreur lors de join thread worker");
+        }
+    }
+
+    pthread_mutex_destroy(&p->verrou);
+    pthread_cond_destroy(&p->tache_dispo);
+    pthread_cond_destroy(&p->tout_fini);
+    free(p->workers);
+    free(p->file);
+    free(p);
+}
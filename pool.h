@@ -0,0 +1,56 @@
+/* pool.h */
+#ifndef POOL_H
+#define POOL_H
+
+#include <pthread.h>
+
+/* Structures de données */
+
+// Une tache executée par un worker du pool
+typedef void (*tache_fn)(void *arg);
+
+typedef struct {
+    tache_fn fn;
+    void *arg;
+    int tour;       // tour du match, pour les mesures d'attente du verrou
+} tache;
+
+typedef struct {
+    pthread_t *workers;
+    int nbr_workers;
+
+    // File des taches prêtes (tampon circulaire extensible)
+    tache *file;
+    int capacite;
+    int tete;
+    int taille;
+
+    int en_cours;   // taches soumises et pas encore terminées
+    int arret;      // demande d'arrêt des workers
+
+    pthread_mutex_t verrou;
+    pthread_cond_t tache_dispo;
+    pthread_cond_t tout_fini;
+} pool;
+
+
+/* ============================ Prototypes ============================ */
+// Renvoie le nombre de coeurs disponibles
+int pool_nbr_coeurs(void);
+
+// Crée un pool de nbr_workers threads (0 = un par coeur)
+pool *pool_creer(int nbr_workers);
+
+// Ajoute une tache prête à la file du pool
+void pool_soumettre(pool *p, tache_fn fn, void *arg);
+
+// Ajoute le match d'un tour à la file du pool (attente du verrou mesurée pour ce tour)
+void pool_soumettre_tour(pool *p, tache_fn fn, void *arg, int tour);
+
+// Attend que toutes les taches soumises (et celles qu'elles soumettent) soient terminées
+void pool_attendre(pool *p);
+
+// Arrête les workers et libére le pool
+void pool_detruire(pool *p);
+
+#endif
@@ -0,0 +1,322 @@
+/**
+ * @file progression.c
+ * @author Ferhat BEZTOUT
+ * @brief Suivi en direct du tournoi : compteurs atomiques, résumé périodique
+ * et état en JSON sur une socket UNIX
+ * @version 1.0
+ * @date 2023-04-02
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <time.h>
+#include <unistd.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#include "progression.h"
+
+// Compteurs : écrits par les workers (relâchés), lus sans verrou par les lecteurs
+static atomic_long prevus[PROGRESSION_TOURS];
+static atomic_long joues[PROGRESSION_TOURS];
+static atomic_long en_cours;
+
+static int active = 0;
+static double debut;
+static double periode_resume;
+static atomic_int arret;
+static pthread_t thread_resume, thread_socket;
+static int fd_socket = -1;
+static char chemin_socket[108];
+
+
+/**
+ * @brief date courante de l'horloge monotone en secondes
+ *
+ * @return double
+ */
+static double maintenant(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/* Instantané des compteurs */
+typedef struct {
+    int tours_finis;        // tours dont tous les matchs sont joués (à partir du premier)
+    int nbr_tours;          // tours ayant des matchs prévus
+    long en_cours;
+    long joues;
+    long prevus;
+    double secondes;
+    double par_seconde;
+    double reste;           // estimation du temps restant en secondes (-1 si inconnu)
+} instantane;
+
+/**
+ * @brief lit les compteurs (chargements atomiques seulement)
+ *
+ * @return instantane
+ */
+static instantane lire(void)
+{
+    instantane e = {0};
+    int premier_inacheve = -1;
+    for (int tour = 0; tour < PROGRESSION_TOURS; tour++)
+    {
+        long p = atomic_load_explicit(&prevus[tour], memory_order_relaxed);
+        long j = atomic_load_explicit(&joues[tour], memory_order_relaxed);
+        if (p == 0)
+        {
+            continue;
+        }
+        e.nbr_tours = tour + 1;
+        e.prevus += p;
+        e.joues += j;
+        if (j < p && premier_inacheve < 0)
+        {
+            premier_inacheve = tour;
+        }
+    }
+    e.tours_finis = (premier_inacheve < 0) ? e.nbr_tours : premier_inacheve;
+    e.en_cours = atomic_load_explicit(&en_cours, memory_order_relaxed);
+    e.secondes = maintenant() - debut;
+    e.par_seconde = (e.secondes > 0) ? e.joues / e.secondes : 0;
+    e.reste = (e.par_seconde > 0) ? (e.prevus - e.joues) / e.par_seconde : -1;
+    return e;
+}
+
+/**
+ * @brief écrit le résumé d'une ligne
+ *
+ * @param f le fichier
+ */
+static void ecrire_resume(FILE *f)
+{
+    instantane e = lire();
+    fprintf(f, "[etat] tours %d/%d, %ld en cours, %ld/%ld matchs, %.0f matchs/s, fin dans %.1f s\n",
+            e.tours_finis, e.nbr_tours, e.en_cours, e.joues, e.prevus, e.par_seconde, e.reste < 0 ? 0 : e.reste);
+    fflush(f);
+}
+
+/**
+ * @brief écrit les compteurs en JSON dans un tampon
+ *
+ * @param tampon le tampon
+ * @param taille sa taille
+ * @return int longueur écrite
+ */
+static int ecrire_json(char *tampon, size_t taille)
+{
+    instantane e = lire();
+    return snprintf(tampon, taille,
+                    "{\"tours_finis\":%d,\"tours\":%d,\"en_cours\":%ld,\"joues\":%ld,\"prevus\":%ld,"
+                    "\"secondes\":%.3f,\"matchs_par_seconde\":%.1f,\"reste_secondes\":%.3f}\n",
+                    e.tours_finis, e.nbr_tours, e.en_cours, e.joues, e.prevus, e.secondes, e.par_seconde, e.reste);
+}
+
+/**
+ * @brief thread du résumé périodique
+ *
+ * @param arg inutilisé
+ * @return void*
+ */
+static void *boucle_resume(void *arg)
+{
+    (void)arg;
+    double prochain = debut + periode_resume;
+    while (!atomic_load(&arret))
+    {
+        if (maintenant() >= prochain)
+        {
+            ecrire_resume(stderr);
+            prochain += periode_resume;
+        }
+        usleep(10000);
+    }
+    return NULL;
+}
+
+/**
+ * @brief thread de la socket : à chaque connexion, répond les compteurs en
+ * JSON. Une requête HTTP reçue dans les 100 ms donne une réponse HTTP
+ * (curl --unix-socket), sinon le JSON seul est envoyé.
+ *
+ * @param arg inutilisé
+ * @return void*
+ */
+static void *boucle_socket(void *arg)
+{
+    (void)arg;
+    char requete[1024], json[512], reponse[1024];
+    while (!atomic_load(&arret))
+    {
+        struct pollfd p = {fd_socket, POLLIN, 0};
+        if (poll(&p, 1, 100) <= 0)
+        {
+            continue;
+        }
+        int client = accept(fd_socket, NULL, NULL);
+        if (client < 0)
+        {
+            continue;
+        }
+
+        struct pollfd pc = {client, POLLIN, 0};
+        int http = poll(&pc, 1, 100) > 0 && read(client, requete, sizeof(requete)) > 0 &&
+                   strncmp(requete, "GET ", 4) == 0;
+        int lg = ecrire_json(json, sizeof(json));
+        if (http)
+        {
+            lg = snprintf(reponse, sizeof(reponse),
+                          "HTTP/1.0 200 OK\r\nContent-Type: application/json\r\nContent-Length: %d\r\n\r\n%s", lg, json);
+            write(client, reponse, lg);
+        }
+        else
+        {
+            write(client, json, lg);
+        }
+        close(client);
+    }
+    return NULL;
+}
+
+/**
+ * @brief ouvre la socket UNIX d'écoute
+ *
+ * @param chemin le chemin de la socket
+ */
+static void ouvrir_socket(const char *chemin)
+{
+    struct sockaddr_un adresse = {0};
+    adresse.sun_family = AF_UNIX;
+    if (strlen(chemin) >= sizeof(adresse.sun_path))
+    {
+        fprintf(stderr, "Chemin de socket trop long : %s\n", chemin);
+        exit(EXIT_FAILURE);
+    }
+    strcpy(adresse.sun_path, chemin);
+    strcpy(chemin_socket, chemin);
+    unlink(chemin);
+
+    fd_socket = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd_socket < 0 || bind(fd_socket, (struct sockaddr *)&adresse, sizeof(adresse)) != 0 ||
+        listen(fd_socket, 16) != 0)
+    {
+        perror("Erreur creation socket etat");
+        exit(EXIT_FAILURE);
+    }
+}
+
+/**
+ * @brief Active les compteurs et démarre les threads de lecture demandés
+ *
+ * @param periode période du résumé sur stderr en secondes (0 : aucun résumé)
+ * @param socket chemin de la socket UNIX (NULL : aucune)
+ */
+void progression_demarrer(double periode, const char *socket)
+{
+    for (int tour = 0; tour < PROGRESSION_TOURS; tour++)
+    {
+        atomic_init(&prevus[tour], 0);
+        atomic_init(&joues[tour], 0);
+    }
+    atomic_init(&en_cours, 0);
+    atomic_store(&arret, 0);
+    debut = maintenant();
+    periode_resume = periode;
+    active = 1;
+
+    if (periode > 0 && pthread_create(&thread_resume, NULL, boucle_resume, NULL) != 0)
+    {
+        perror("Erreur lors de creation thread etat");
+        exit(EXIT_FAILURE);
+    }
+    if (socket != NULL)
+    {
+        ouvrir_socket(socket);
+        if (pthread_create(&thread_socket, NULL, boucle_socket, NULL) != 0)
+        {
+            perror("Erreur lors de creation thread etat");
+            exit(EXIT_FAILURE);
+        }
+    }
+}
+
+/**
+ * @brief Renvoie 1 si les compteurs sont actifs
+ *
+ * @return int
+ */
+int progression_active(void)
+{
+    return active;
+}
+
+/**
+ * @brief Ajoute des matchs à jouer dans un tour
+ *
+ * @param tour le tour
+ * @param nbr_matchs nombre de matchs qui seront joués
+ */
+void progression_prevoir(int tour, long nbr_matchs)
+{
+    if (active && tour < PROGRESSION_TOURS)
+    {
+        atomic_fetch_add_explicit(&prevus[tour], nbr_matchs, memory_order_relaxed);
+    }
+}
+
+/**
+ * @brief Un match commence
+ */
+void progression_debut_match(void)
+{
+    atomic_fetch_add_explicit(&en_cours, 1, memory_order_relaxed);
+}
+
+/**
+ * @brief Un match est terminé
+ *
+ * @param tour son tour
+ */
+void progression_fin_match(int tour)
+{
+    atomic_fetch_sub_explicit(&en_cours, 1, memory_order_relaxed);
+    if (tour < PROGRESSION_TOURS)
+    {
+        atomic_fetch_add_explicit(&joues[tour], 1, memory_order_relaxed);
+    }
+}
+
+/**
+ * @brief Arrête les threads de lecture et affiche un dernier résumé
+ */
+void progression_arreter(void)
+{
+    if (!active)
+    {
+        return;
+    }
+    atomic_store(&arret, 1);
+    if (periode_resume > 0)
+    {
+        pthread_join(thread_resume, NULL);
+        ecrire_resume(stderr);
+    }
+    if (fd_socket >= 0)
+    {
+        pthread_join(thread_socket, NULL);
+        close(fd_socket);
+        unlink(chemin_socket);
+        fd_socket = -1;
+    }
+    active = 0;
+}
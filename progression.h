@@ -0,0 +1,29 @@
+/* progression.h */
+#ifndef PROGRESSION_H
+#define PROGRESSION_H
+
+/* Définitions des constantes */
+#define PROGRESSION_TOURS 32    // tours suivis au plus
+
+
+/* ============================ Prototypes ============================ */
+// Active les compteurs ; periode > 0 : résumé sur stderr toutes les periode secondes,
+// socket != NULL : les compteurs en JSON (HTTP) sur cette socket UNIX
+void progression_demarrer(double periode, const char *socket);
+
+// Renvoie 1 si les compteurs sont actifs
+int progression_active(void);
+
+// Nombre de matchs à jouer dans un tour (hors exempts et matchs déjà joués)
+void progression_prevoir(int tour, long nbr_matchs);
+
+// Un match commence
+void progression_debut_match(void);
+
+// Un match du tour est terminé
+void progression_fin_match(int tour);
+
+// Arrête le résumé et la socket (dernier résumé affiché)
+void progression_arreter(void);
+
+#endif
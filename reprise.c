@@ -0,0 +1,220 @@
+/**
+ * @file reprise.c
+ * @author Ferhat BEZTOUT
+ * @brief Sauvegarde d'un tournoi en cours et reprise aprés un arrêt : equipes,
+ * graine et resultats des matchs terminés dans un fichier binaire versionné
+ * @version 1.0
+ * @date 2023-04-02
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "main.h"
+#include "reprise.h"
+#include "journal.h"
+#include "modele.h"
+
+// Resultats lus par reprise_charger, en attente de reprise_appliquer
+static evenement *resultats = NULL;
+static long nbr_resultats = 0;
+
+
+/**
+ * @brief écrit un bloc de la sauvegarde
+ *
+ * @param f le fichier
+ * @param donnees les données
+ * @param taille leur taille
+ */
+static void ecrire(FILE *f, const void *donnees, size_t taille)
+{
+    if (taille > 0 && fwrite(donnees, taille, 1, f) != 1)
+    {
+        perror("Erreur d'ecriture sauvegarde");
+        exit(EXIT_FAILURE);
+    }
+}
+
+/**
+ * @brief lit un bloc de la sauvegarde
+ *
+ * @param f le fichier
+ * @param donnees destination
+ * @param taille taille attendue
+ */
+static void lire(FILE *f, void *donnees, size_t taille)
+{
+    if (taille > 0 && fread(donnees, taille, 1, f) != 1)
+    {
+        fprintf(stderr, "Sauvegarde tronquée ou invalide\n");
+        exit(EXIT_FAILURE);
+    }
+}
+
+/**
+ * @brief Crée la sauvegarde : en-tête, longueur des noms, notes puis noms des equipes.
+ * Le journal y ajoute ensuite le resultat de chaque match (voir journal_ouvrir).
+ *
+ * @param chemin le chemin du fichier
+ * @param t la table des equipes
+ * @param graine la graine du tournoi
+ * @return FILE* le fichier ouvert en ajout
+ */
+FILE *reprise_creer(const char *chemin, const table_equipes *t, uint64_t graine)
+{
+    FILE *f = fopen(chemin, "wb");
+    if (f == NULL)
+    {
+        perror("Erreur d'ouverture fichier sauvegarde");
+        exit(EXIT_FAILURE);
+    }
+
+    entete_reprise entete = {REPRISE_SIGNATURE, REPRISE_VERSION, graine, t->nbr, sizeof(evenement), 0};
+    for (Equipe e = 0; e < t->nbr; e++)
+    {
+        entete.taille_noms += t->tab[e].lg_nom;
+    }
+    ecrire(f, &entete, sizeof(entete));
+    for (Equipe e = 0; e < t->nbr; e++)
+    {
+        ecrire(f, &t->tab[e].lg_nom, sizeof(uint32_t));
+    }
+    for (Equipe e = 0; e < t->nbr; e++)
+    {
+        ecrire(f, &t->tab[e].note, sizeof(int32_t));
+    }
+    for (Equipe e = 0; e < t->nbr; e++)
+    {
+        ecrire(f, nom_equipe(t, e), lg_nom_equipe(t, e));
+    }
+    fflush(f);
+    fsync(fileno(f));
+    return f;
+}
+
+/**
+ * @brief Recharge une sauvegarde : les equipes (dans le même ordre, avec leurs
+ * notes) et la graine, puis les resultats déjà enregistrés, gardés pour
+ * reprise_appliquer. Un resultat incomplet en fin de fichier (arrêt pendant
+ * l'écriture) est retiré. Le coût est linéaire en la taille de la sauvegarde.
+ *
+ * @param chemin le chemin du fichier
+ * @param t la table des equipes (vide)
+ * @param graine reçoit la graine du tournoi
+ * @return FILE* le fichier ouvert en ajout, pour continuer la sauvegarde
+ */
+FILE *reprise_charger(const char *chemin, table_equipes *t, uint64_t *graine)
+{
+    FILE *f = fopen(chemin, "rb");
+    if (f == NULL)
+    {
+        perror("Erreur d'ouverture fichier sauvegarde");
+        exit(EXIT_FAILURE);
+    }
+
+    entete_reprise entete;
+    lire(f, &entete, sizeof(entete));
+    if (entete.signature != REPRISE_SIGNATURE || entete.version != REPRISE_VERSION ||
+        entete.taille_evenement != sizeof(evenement) || entete.nbr_equipes < 0)
+    {
+        fprintf(stderr, "%s n'est pas une sauvegarde de tournoi (version %d)\n", chemin, REPRISE_VERSION);
+        exit(EXIT_FAILURE);
+    }
+    *graine = entete.graine;
+
+    uint32_t *lg = malloc((entete.nbr_equipes + 1) * sizeof(uint32_t));
+    int32_t *notes = malloc((entete.nbr_equipes + 1) * sizeof(int32_t));
+    char *noms = malloc(entete.taille_noms + 1);
+    if (lg == NULL || notes == NULL || noms == NULL)
+    {
+        perror("Erreur allocation memoire");
+        exit(EXIT_FAILURE);
+    }
+    lire(f, lg, entete.nbr_equipes * sizeof(uint32_t));
+    lire(f, notes, entete.nbr_equipes * sizeof(int32_t));
+    lire(f, noms, entete.taille_noms);
+    size_t position = 0;
+    for (int i = 0; i < entete.nbr_equipes; i++)
+    {
+        if (lg[i] > entete.taille_noms - position)
+        {
+            fprintf(stderr, "Sauvegarde tronquée ou invalide\n");
+            exit(EXIT_FAILURE);
+        }
+        Equipe e = ajouter_equipe(t, noms + position, lg[i]);
+        t->tab[e].note = notes[i];
+        t->notee |= (notes[i] != MODELE_NOTE_DEFAUT);
+        position += lg[i];
+    }
+    free(lg);
+    free(notes);
+    free(noms);
+
+    // Resultats : autant d'enregistrements complets qu'il en reste
+    long debut = ftell(f);
+    fseek(f, 0, SEEK_END);
+    nbr_resultats = (ftell(f) - debut) / (long)sizeof(evenement);
+    fseek(f, debut, SEEK_SET);
+    resultats = malloc((nbr_resultats + 1) * sizeof(evenement));
+    if (resultats == NULL)
+    {
+        perror("Erreur allocation memoire");
+        exit(EXIT_FAILURE);
+    }
+    lire(f, resultats, nbr_resultats * sizeof(evenement));
+    fclose(f);
+
+    if (truncate(chemin, debut + nbr_resultats * (long)sizeof(evenement)) != 0)
+    {
+        perror("Erreur de troncature sauvegarde");
+        exit(EXIT_FAILURE);
+    }
+    f = fopen(chemin, "ab");
+    if (f == NULL)
+    {
+        perror("Erreur d'ouverture fichier sauvegarde");
+        exit(EXIT_FAILURE);
+    }
+    return f;
+}
+
+/**
+ * @brief Replace dans mon_tournoi (equipes placées au tour 0) le gagnant et le
+ * score de chaque match sauvegardé. construire_arbre considére ensuite ces matchs
+ * comme résolus : seuls les matchs restants sont joués, avec les mêmes flux
+ * aléatoires que lors du premier lancement.
+ *
+ * @return long nombre de matchs repris
+ */
+long reprise_appliquer(void)
+{
+    tournoi *t = &mon_tournoi;
+    long repris = 0;
+    for (long i = 0; i < nbr_resultats; i++)
+    {
+        const evenement *ev = &resultats[i];
+        if (ev->tour < 0 || ev->tour >= t->nbrTour || ev->num_match < 0 ||
+            ev->num_match >= (t->taille >> (ev->tour + 1)) || ev->equipe < 0 || ev->equipe >= team_count)
+        {
+            fprintf(stderr, "Resultat %ld invalide dans la sauvegarde, ignoré\n", i);
+            continue;
+        }
+        inserer_equipe_tournoi(*t, ev->tour + 1, ev->num_match, ev->equipe);
+        if (ev->e1 >= 0 && ev->e1 < team_count && ev->e2 >= 0 && ev->e2 < team_count)
+        {
+            noter_resultat(ev->tour, ev->num_match, ev->equipe, (ev->equipe == ev->e1) ? ev->e2 : ev->e1,
+                           ev->score_e1, ev->score_e2,
+                           RESULTAT_JOUE | (ev->type == EV_PENALTIES ? RESULTAT_PENALTIES : 0));
+        }
+        repris++;
+    }
+    free(resultats);
+    resultats = NULL;
+    nbr_resultats = 0;
+    return repris;
+}
@@ -0,0 +1,39 @@
+/* reprise.h */
+#ifndef REPRISE_H
+#define REPRISE_H
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include "equipes.h"
+
+/* Définitions des constantes */
+#define REPRISE_SIGNATURE 0x524e5254   // "TRNR"
+#define REPRISE_VERSION 2
+
+/* Structures de données */
+
+// En-tête de la sauvegarde, suivi de la longueur de chaque nom (uint32), de la
+// note de chaque equipe (int32), des noms bout à bout, puis des resultats de
+// match (evenement du journal) ajoutés au fil du tournoi
+typedef struct {
+    uint32_t signature;
+    uint32_t version;
+    uint64_t graine;
+    int32_t nbr_equipes;
+    uint32_t taille_evenement;
+    uint64_t taille_noms;
+} entete_reprise;
+
+
+/* ============================ Prototypes ============================ */
+// Crée la sauvegarde (en-tête, equipes) ; les resultats y sont ajoutés par le journal
+FILE *reprise_creer(const char *chemin, const table_equipes *t, uint64_t graine);
+
+// Recharge equipes et graine d'une sauvegarde ; renvoie le fichier ouvert pour y continuer
+FILE *reprise_charger(const char *chemin, table_equipes *t, uint64_t *graine);
+
+// Replace dans mon_tournoi les resultats chargés par reprise_charger ; renvoie le nombre de matchs repris
+long reprise_appliquer(void);
+
+#endif
@@ -0,0 +1,912 @@
+/**
+ * @file tournoi.c
+ * @author Ferhat BEZTOUT
+ * @brief Moteur du tournoi : tours, arbre des matchs et simulation
+ * @version 1.0
+ * @date 2023-04-02
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <unistd.h>
+
+#include "main.h"
+#include "pool.h"
+#include "journal.h"
+#include "alea.h"
+#include "mesures.h"
+#include "modele.h"
+#include "progression.h"
+#include "cadence.h"
+
+table_equipes mes_equipes;
+tournoi mon_tournoi;
+
+int team_count;
+int nbr_tours;
+double vitesse = 1.0;   // facteur temps réel (0 = aussi vite que possible)
+uint64_t graine;        // graine maître : un flux aléatoire par match en dérive
+
+pool *mon_pool;
+
+// Partie de l'arbre jouée par ce processus : tours [tour_debut, tour_fin), sous
+// arbre bloc parmi nbr_blocs (voir simuler_tours)
+static int tour_debut, tour_fin;
+static int bloc, nbr_blocs = 1;
+
+
+/**
+ * @brief Crée le tableau des tours du tournoi. Chaque tour est un tableau dense
+ * d'equipes (taille >> i places pour le tour i), tous rangés dans un même bloc ;
+ * le tour nbrTour reçoit le vainqueur. La place i du tour r+1 appartient au
+ * match i du tour r, les places vides valent -1. Les tours, leurs places,
+ * l'arbre des matchs, les resultats et les parcours sont alloués dans une
+ * seule arène : aucun malloc pendant la simulation, une seule libération à la fin.
+ *
+ * @param nbrTour Nombre de tour du tournoi
+ * @return t un tournoi
+ */
+tournoi nouveau_tournoi(int nbrTour)
+{
+    tournoi t;
+    t.nbrTour = nbrTour;
+    t.taille = 1 << nbrTour;
+
+    size_t taille_tours = (nbrTour + 1) * sizeof(Equipe *);
+    size_t taille_places = (2 * t.taille - 1) * sizeof(Equipe);
+    size_t taille_matchs = t.taille * sizeof(match);    // taille - 1 matchs, au moins un
+    size_t taille_resultats = t.taille * sizeof(resultat_match);
+    size_t taille_parcours = t.taille * sizeof(parcours_equipe);
+    t.memoire = arene_creer(arene_taille_bloc(taille_tours) + arene_taille_bloc(taille_places) +
+                            arene_taille_bloc(taille_matchs) + arene_taille_bloc(taille_resultats) +
+                            arene_taille_bloc(taille_parcours));
+    t.tour = arene_allouer(&t.memoire, taille_tours);
+    Equipe *places = arene_allouer(&t.memoire, taille_places);
+    t.matchs = arene_allouer(&t.memoire, taille_matchs);
+    t.resultats = arene_allouer(&t.memoire, taille_resultats);
+    t.parcours = arene_allouer(&t.memoire, taille_parcours);
+
+    memset(places, -1, taille_places);
+    memset(t.resultats, 0, taille_resultats);
+    memset(t.parcours, -1, taille_parcours);
+    for (int i = 0; i <= nbrTour; i++)
+    {
+        t.tour[i] = places;
+        places += t.taille >> i;
+    }
+    return t;
+}
+
+/**
+ * @brief Récupérer le tableau des equipes d'un tour i
+ *
+ * @param t structure contenant les tours
+ * @param index tour desiré
+ * @return Equipe* (NULL si hors limite)
+ */
+Equipe *get_equipe_tournoi(tournoi t, int index_tour)
+{
+    if (index_tour < 0 || index_tour > t.nbrTour)
+    {
+        printf("Index hors limite.\n");
+        return NULL;
+    }
+    return t.tour[index_tour];
+}
+
+/**
+ * @brief Insérer une equipe à une place donnée d'un tour i. Chaque place n'a
+ * qu'un seul écrivain (le match qui la qualifie) : aucun verrou n'est nécessaire.
+ *
+ * @param t structure contenant les tours
+ * @param index_tour tour désiré
+ * @param place place de l'equipe dans le tour
+ * @param equipe equipe à inserer
+ */
+void inserer_equipe_tournoi(tournoi t, int index_tour, int place, Equipe equipe)
+{
+    if (index_tour < 0 || index_tour > t.nbrTour || place < 0 || place >= (t.taille >> index_tour))
+    {
+        printf("insert : Index %d place %d hors limite.\n",index_tour, place);
+        
+        
+    } else {
+        t.tour[index_tour][place] = equipe;
+    }
+   
+}
+
+/**
+ * @brief Affiche toutes les équipes de chaque tour
+ *
+ * @param t structure contenant les tours
+ */
+void afficher_equipe_tournoi(tournoi t)
+{
+    printf("=======Tournoi=======\n");
+    for (int i = 0; i <= t.nbrTour; i++)
+    {
+        if (i < t.nbrTour)
+        {
+            printf("-Equipes du tour %d :\n", i);
+        }
+        else
+        {
+            printf("-Vainqueur :\n");
+        }
+        for (int j = 0; j < (t.taille >> i); j++)
+        {
+            Equipe e = t.tour[i][j];
+            if (e < 0)
+            {
+                continue;
+            }
+            printf("\tid:%d, nom: %.*s\n", mes_equipes.tab[e].id, lg_nom_equipe(&mes_equipes, e), nom_equipe(&mes_equipes, e));
+        }
+    }
+}
+
+/**
+ * @brief Libérer le tableau des tours (fin du tournoi) : toute l'arène d'un coup
+ *
+ * @param t structure contenant les tours
+ */
+void liberer_equipe_tournoi(tournoi t)
+{
+    arene_liberer(&t.memoire);
+}
+
+/**
+ * @brief Vide les tours 1 et suivants et les resultats (le placement du tour 0
+ * est gardé) pour rejouer le tournoi sans rien réallouer ; l'arbre des matchs
+ * est reconstruit par simuler_tours.
+ *
+ * @param t le tournoi
+ */
+void reinitialiser_tournoi(tournoi *t)
+{
+    if (t->nbrTour > 0)
+    {
+        memset(t->tour[1], -1, (t->taille - 1) * sizeof(Equipe));
+    }
+    memset(t->resultats, 0, t->taille * sizeof(resultat_match));
+    for (int place = 0; place < t->taille; place++)
+    {
+        if (t->tour[0][place] >= 0)
+        {
+            t->parcours[t->tour[0][place]].tour_atteint = 0;
+        }
+    }
+}
+
+
+
+/**
+ * @brief Récupérer l'equipe d'une place d'un tour i. La place reste remplie
+ * (les tours gardent l'historique du tournoi).
+ *
+ * @param t structure contenant les tours
+ * @param index_tour tour désiré
+ * @param place place de l'equipe dans le tour
+ * @return Equipe (-1 si la place est vide)
+ */
+Equipe pop_equipe_at_tour(tournoi *t, int index_tour, int place)
+{
+    return t->tour[index_tour][place];
+}
+
+
+
+/**
+ * @brief Verifie si un entier est une puissance de 2
+ *
+ * @param n le nombre entier
+ * @return int
+ */
+int is_power_two(int n)
+{
+    if (n <= 0)
+    {
+        return 0;
+    }
+    return (n & (n - 1)) == 0;
+}
+
+/**
+ * @brief Renvoie la puissanec de 2 la plus proche inférieur à n
+ *
+ * @param n le nombre entier
+ * @return int
+ */
+int nearest_power_two(int n)
+{
+    if (n <= 0)
+    {
+        return 0;
+    }
+    int i = 0;
+    while ((1 << i) <= n)
+    {
+        i++;
+    }
+    return (1 << (i - 1));
+}
+
+/**
+ * @brief débute le tournoi en plaçant toutes les equipe au tour 0. S'il y a
+ * moins d'equipes que de places, les premiéres equipes sont exemptées du tour 0 :
+ * l'equipe i (i < nombre d'exempts) occupe la place 2i et la place 2i+1 reste
+ * vide. Chaque match a donc au plus un exempt et aucune equipe n'est perdue.
+ *
+ * @param t un tournoi donné
+ * @param e la table des equipes (au plus t->taille equipes)
+ */
+void start_tournoi(tournoi *t, table_equipes *e)
+{
+    int nbr = (e->nbr < t->taille) ? e->nbr : t->taille;
+    int exempts = t->taille - nbr;
+    int place = 0;
+    for (Equipe i = 0; i < nbr; i++)
+    {
+        inserer_equipe_tournoi(*t, 0, place, i);
+        t->parcours[i].place = place;
+        t->parcours[i].tour_atteint = 0;
+        place += (i < exempts) ? 2 : 1;
+    }
+}
+
+
+
+/**
+ * @brief numéro d'un match dans l'arbre, les matchs étant rangés tour par tour :
+ * les tours precedents comptent taille/2 + taille/4 + ... = taille - (taille >> tour) matchs
+ *
+ * @param tour numéro du tour
+ * @param num_match position du match dans le tour
+ * @return int
+ */
+int id_match(int tour, int num_match)
+{
+    return mon_tournoi.taille - (mon_tournoi.taille >> tour) + num_match;
+}
+
+
+/**
+ * @brief fait s'écouler la durée d'une action. Le temps de match est simulé :
+ * on ne dort que si la simulation est cadencée, vitesse fois plus vite que le réel.
+ *
+ * @param duree_us durée simulée de l'action en micro seconde
+ */
+static void attendre_action(int duree_us)
+{
+    if (vitesse > 0)
+    {
+        usleep((useconds_t)(duree_us / vitesse));
+    }
+}
+
+
+/**
+ * @brief coup d'envoi d'un match : prépare son état (flux aléatoire du match,
+ * seuil tiré des notes des equipes, modele.h) sans jouer d'action
+ *
+ * @param p l'état du match
+ * @param e1 premiére equipe
+ * @param e2 seconde equipe
+ * @param tour numéro du tour
+ * @param num_match numéro du match dans le tour
+ */
+void partie_debut(partie *p, Equipe e1, Equipe e2, int tour, int num_match)
+{
+    alea_init(&p->a, graine, (uint64_t)id_match(tour, num_match));
+    p->seuil = modele_seuil(&mes_equipes, e1, e2);
+    p->e1 = e1;
+    p->e2 = e2;
+    p->tour = tour;
+    p->num_match = num_match;
+    p->temps = 0;
+    p->score_e1 = 0;
+    p->score_e2 = 0;
+    journal(JOURNAL_DETAIL, EV_COUP_ENVOI, tour, num_match, e1, e2, e1, 0, 0);
+}
+
+/**
+ * @brief joue l'action suivante d'un match (il en reste si temps < DUREE_MATCH)
+ *
+ * @param p l'état du match
+ * @return int durée simulée de l'action, en micro seconde, avant la suivante
+ */
+int partie_action(partie *p)
+{
+    // Simuler une action
+    if (alea_borne(&p->a, 5) == 0)
+    { // 1 chance sur 10 de marquer un but
+        if ((uint32_t)(alea_suivant(&p->a) >> 32) < p->seuil)
+        {                  // si l'équipe 1 marque
+            p->score_e1++; // incrémenter le score de l'équipe 1
+            journal(JOURNAL_DETAIL, EV_BUT, p->tour, p->num_match, p->e1, p->e2, p->e1, p->score_e1, p->score_e2);
+        }
+        else
+        {                  // si l'équipe 2 marque
+            p->score_e2++; // incrémenter le score de l'équipe 2
+            journal(JOURNAL_DETAIL, EV_BUT, p->tour, p->num_match, p->e1, p->e2, p->e2, p->score_e1, p->score_e2);
+        }
+    }
+    p->temps++;
+    return (int)alea_borne(&p->a, MAX_DUREE_ACTION); // durée de l'action avant la suivante
+}
+
+/**
+ * @brief note le resultat d'un match et le tour atteint par ses deux equipes
+ *
+ * @param tour numéro du tour
+ * @param num_match numéro du match dans le tour
+ * @param eg l'equipe gagnante
+ * @param ep l'equipe perdante
+ * @param score_e1 score de e1
+ * @param score_e2 score de e2
+ * @param drapeaux drapeaux RESULTAT_*
+ */
+void noter_resultat(int tour, int num_match, Equipe eg, Equipe ep, int score_e1, int score_e2, int drapeaux)
+{
+    resultat_match *r = &mon_tournoi.resultats[id_match(tour, num_match)];
+    r->score_e1 = (uint8_t)score_e1;
+    r->score_e2 = (uint8_t)score_e2;
+    r->drapeaux = (uint8_t)drapeaux;
+    mon_tournoi.parcours[eg].tour_atteint = tour + 1;
+    mon_tournoi.parcours[ep].tour_atteint = tour;
+}
+
+/**
+ * @brief fin d'un match dont toutes les actions sont jouées : renvoie l'equipe
+ * gagnante (tirage aux penalties en cas d'égalité) et note le resultat dans le
+ * tournoi (resultats, parcours)
+ *
+ * @param p l'état du match
+ * @return Equipe
+ */
+Equipe partie_fin(partie *p)
+{
+    int tour = p->tour, num_match = p->num_match;
+    Equipe e1 = p->e1, e2 = p->e2;
+    int score_e1 = p->score_e1, score_e2 = p->score_e2;
+    type_evenement type = EV_GAGNANT;
+    Equipe eg;
+
+    journal(JOURNAL_DETAIL, EV_SCORE_FINAL, tour, num_match, e1, e2, e1, score_e1, score_e2);
+    // Déterminer l'équipe gagnante
+    if (score_e1 != score_e2)
+    {
+        eg = (score_e1 > score_e2) ? e1 : e2;
+    }
+    else
+    {
+        type = EV_PENALTIES;
+        eg = ((uint32_t)(alea_suivant(&p->a) >> 32) < p->seuil) ? e1 : e2;
+    }
+    journal(JOURNAL_RESULTAT, type, tour, num_match, e1, e2, eg, score_e1, score_e2);
+    noter_resultat(tour, num_match, eg, (eg == e1) ? e2 : e1, score_e1, score_e2,
+                   RESULTAT_JOUE | (type == EV_PENALTIES ? RESULTAT_PENALTIES : 0));
+    return eg;
+}
+
+/**
+ * @brief simule un match action par action et renvoie l'equipe gagnante
+ * (tirage aux penalties en cas d'égalité). Le côté qui marque et le vainqueur
+ * aux penalties dépendent des notes des equipes (modele.h), 50/50 à notes
+ * égales. Les commentaires passent par le journal.
+ * Le hasard du match vient de son propre flux (graine, id du match) : le
+ * résultat ne dépend ni du thread ni de l'ordre d'execution. Le thread dort
+ * pendant les actions ; en temps réel, cadence.c joue les mêmes étapes sans dormir.
+ *
+ * @param e1 premiére equipe
+ * @param e2 seconde equipe
+ * @param tour numéro du tour
+ * @param num_match numéro du match dans le tour
+ * @return Equipe
+ */
+Equipe simuler_match(Equipe e1, Equipe e2, int tour, int num_match)
+{
+    partie p;
+    partie_debut(&p, e1, e2, tour, num_match);
+    while (p.temps < DUREE_MATCH)
+    {
+        attendre_action(partie_action(&p));
+    }
+    return partie_fin(&p);
+}
+
+
+
+/**
+ * @brief renvoie le match (tour, num_match) de l'arbre du tournoi
+ *
+ * @param tour numéro du tour
+ * @param num_match position du match dans le tour
+ * @return match*
+ */
+static match *get_match(int tour, int num_match)
+{
+    return &mon_tournoi.matchs[id_match(tour, num_match)];
+}
+
+
+/**
+ * @brief premier match du bloc joué par ce processus dans un tour
+ *
+ * @param tour numéro du tour
+ * @return int
+ */
+static int premier_match(int tour)
+{
+    return bloc * ((mon_tournoi.taille >> (tour + 1)) / nbr_blocs);
+}
+
+/**
+ * @brief nombre de matchs du bloc joué par ce processus dans un tour
+ *
+ * @param tour numéro du tour
+ * @return int
+ */
+static int nbr_matchs_bloc(int tour)
+{
+    return (mon_tournoi.taille >> (tour + 1)) / nbr_blocs;
+}
+
+
+/**
+ * @brief construit l'arbre du tournoi : le match i du tour r joue les equipes
+ * des places 2i et 2i+1 du tour r, qualifiées par les matchs 2i et 2i+1 du
+ * tour r-1. Un match dont le gagnant est déjà à sa place au tour suivant
+ * (reprise d'une sauvegarde) est résolu (attente = -1) et compte comme une
+ * equipe de moins à attendre pour le match suivant. Au tour 0, l'equipe
+ * exemptée d'un match est qualifiée directement au tour 1, sans match.
+ * Seuls les matchs de la partie jouée (tours et bloc de simuler_tours) sont construits.
+ *
+ * @param t le tournoi (equipes placées au premier tour joué)
+ */
+void construire_arbre(tournoi *t)
+{
+    for (int tour = tour_debut; tour < tour_fin; tour++)
+    {
+        int premier = premier_match(tour);
+        for (int i = premier; i < premier + nbr_matchs_bloc(tour); i++)
+        {
+            match *m = get_match(tour, i);
+            m->num_match = i;
+            m->num_tour = tour;
+            atomic_init(&m->attente, tour == tour_debut ? 0 : 2);
+        }
+    }
+
+    // Tour par tour : les matchs résolus d'un tour le sont avant de regarder le suivant
+    for (int tour = tour_debut; tour < tour_fin; tour++)
+    {
+        int premier = premier_match(tour);
+        for (int i = premier; i < premier + nbr_matchs_bloc(tour); i++)
+        {
+            if (tour == 0 && pop_equipe_at_tour(t, 0, 2 * i + 1) < 0 && pop_equipe_at_tour(t, 1, i) < 0)
+            {
+                Equipe e = pop_equipe_at_tour(t, 0, 2 * i);
+                inserer_equipe_tournoi(*t, 1, i, e);
+                t->parcours[e].tour_atteint = 1;
+                journal(JOURNAL_RESULTAT, EV_EXEMPT, 0, i, e, e, e, 0, 0);
+            }
+            if (pop_equipe_at_tour(t, tour + 1, i) < 0)
+            {
+                continue;
+            }
+            atomic_store(&get_match(tour, i)->attente, -1);
+            if (tour + 1 < tour_fin)
+            {
+                atomic_fetch_sub(&get_match(tour + 1, i / 2)->attente, 1);
+            }
+        }
+    }
+}
+
+
+/**
+ * @brief simule un tour du tournoi : soumet au pool (aux boucles de cadence.c
+ * en temps réel) ses matchs déjà jouables
+ * (au premier tour joué, ou dont les deux matchs precedents sont résolus
+ * d'avance : exempts, reprise). Les autres deviennent jouables dés que leurs
+ * deux matchs precedents sont terminés.
+ *
+ * @param tour numéro du tour
+ */
+void simuler_tour(int tour)
+{
+    int premier = premier_match(tour);
+
+    // Lancer les matchs parallélement
+    for (int i = premier; i < premier + nbr_matchs_bloc(tour); i++)
+    {
+        match *m = get_match(tour, i);
+        if (atomic_load(&m->attente) == 0)
+        {
+            m->pret_ns = mesures_actives() ? mesures_maintenant() : 0;
+            if (vitesse > 0)
+            {
+                cadence_soumettre(m);
+            }
+            else
+            {
+                pool_soumettre_tour(mon_pool, thread_function_match, m, tour);
+            }
+        }
+    }
+}
+
+
+
+
+
+/**
+ * @brief qualifie le gagnant d'un match joué à sa place du tour suivant et
+ * renvoie le match suivant s'il devient jouable : le second match qualifié
+ * apporte sa seconde equipe, son thread l'enchaîne directement.
+ *
+ * @param m le match joué
+ * @param e1 premiére equipe
+ * @param e2 seconde equipe
+ * @param eg l'equipe gagnante
+ * @param fin date de fin du match (mesures)
+ * @return match* le match suivant, NULL s'il attend encore une equipe
+ */
+match *qualifier(match *m, Equipe e1, Equipe e2, Equipe eg, uint64_t fin)
+{
+    int tour = m->num_tour;
+    int num_match = m->num_match;
+
+    // Chaque match posséde sa place dans le tour suivant : pas de verrou
+    inserer_equipe_tournoi(mon_tournoi, tour + 1, num_match, eg);
+
+    if (tour + 1 == tour_fin)
+    {
+        if (tour_fin == nbr_tours)
+        {
+            journal(JOURNAL_ESSENTIEL, EV_VAINQUEUR, tour, num_match, e1, e2, eg, 0, 0);
+        }
+        return NULL;
+    }
+
+    match *suivant = get_match(tour + 1, num_match / 2);
+    if (atomic_fetch_sub(&suivant->attente, 1) != 1)
+    {
+        return NULL;
+    }
+    suivant->pret_ns = fin;
+    return suivant;
+}
+
+/**
+ * @brief Tache du pool : joue un match puis qualifie le gagnant dans le match
+ * suivant de l'arbre. Le worker qui apporte la seconde equipe enchaîne
+ * directement ce match, sans repasser par la file.
+ *
+ * @param arg le match à jouer (ses deux equipes sont connues)
+ */
+void thread_function_match(void *arg)
+{
+    match *m = (match *)arg;
+    int mesurer = mesures_actives();
+    int suivre = progression_active();
+
+    while (m != NULL)
+    {
+        int tour = m->num_tour;
+        int num_match = m->num_match;
+        uint64_t debut = 0;
+
+        Equipe e1 = pop_equipe_at_tour(&mon_tournoi, tour, 2 * num_match);
+        Equipe e2 = pop_equipe_at_tour(&mon_tournoi, tour, 2 * num_match + 1);
+
+        if (mesurer)
+        {
+            debut = mesures_maintenant();
+            mesure_ajouter(MESURE_ATTENTE_FILE, tour, debut - m->pret_ns);
+        }
+
+        /* Simuler le match */
+        if (suivre)
+        {
+            progression_debut_match();
+        }
+        Equipe eg = simuler_match(e1, e2, tour, num_match);
+        if (suivre)
+        {
+            progression_fin_match(tour);
+        }
+
+        uint64_t fin = 0;
+        if (mesurer)
+        {
+            fin = mesures_maintenant();
+            mesure_ajouter(MESURE_DUREE_MATCH, tour, fin - debut);
+        }
+
+        m = qualifier(m, e1, e2, eg, fin);
+    }
+}
+
+
+
+/**
+ * @brief joue une partie du tournoi mon_tournoi sur un pool de workers et
+ * attend sa fin : les tours [debut, fin) du sous arbre bloc, l'arbre étant
+ * coupé en nbr sous arbres (nbr puissance de 2, au plus une place par sous
+ * arbre au tour fin). Les equipes du tour debut doivent être placées ; les
+ * vainqueurs des sous arbres sont à leur place au tour fin.
+ *
+ * @param p le pool de workers
+ * @param debut premier tour joué
+ * @param fin tour où s'arrête la partie jouée (nbr_tours pour aller jusqu'au vainqueur)
+ * @param num_bloc sous arbre joué
+ * @param nbr nombre de sous arbres
+ */
+void simuler_tours(pool *p, int debut, int fin, int num_bloc, int nbr)
+{
+    mon_pool = p;
+    tour_debut = debut;
+    tour_fin = fin;
+    bloc = num_bloc;
+    nbr_blocs = nbr;
+
+    // Les noeuds des matchs sont dans l'arène du tournoi
+    construire_arbre(&mon_tournoi);
+    if (progression_active())
+    {
+        // Matchs à jouer : ni exempts, ni déjà joués
+        for (int tour = debut; tour < fin; tour++)
+        {
+            long a_jouer = 0;
+            int premier = premier_match(tour);
+            for (int i = premier; i < premier + nbr_matchs_bloc(tour); i++)
+            {
+                a_jouer += atomic_load(&get_match(tour, i)->attente) >= 0;
+            }
+            progression_prevoir(tour, a_jouer);
+        }
+    }
+
+    // En temps réel, les matchs passent leur temps à attendre l'action suivante :
+    // ils sont cadencés par autant de boucles d'evenements que de workers
+    if (vitesse > 0)
+    {
+        cadence_demarrer(p->nbr_workers, mon_tournoi.taille - 1);
+    }
+
+    // Du dernier tour au premier : un match soumis ne rend jouables que des
+    // matchs de tours déjà parcourus, qui ne sont donc pas soumis deux fois
+    for (int tour = fin - 1; tour >= debut; tour--)
+    {
+        simuler_tour(tour);
+    }
+    if (vitesse > 0)
+    {
+        cadence_attendre();
+        cadence_arreter();
+    }
+    else
+    {
+        pool_attendre(p);
+    }
+
+    bloc = 0;
+    nbr_blocs = 1;
+}
+
+/**
+ * @brief joue le tournoi mon_tournoi (equipes déjà placées au tour 0) sur un
+ * pool de workers et attend sa fin
+ *
+ * @param p le pool de workers
+ */
+void simuler_tournoi(pool *p)
+{
+    simuler_tours(p, 0, nbr_tours, 0, 1);
+}
+
+
+
+/**
+ * @brief rejoue un match d'un et si, sans cadence : le tournoi est fini, seul
+ * le resultat compte
+ *
+ * @param e1 premiére equipe
+ * @param e2 seconde equipe
+ * @param tour numéro du tour
+ * @param num_match numéro du match dans le tour
+ * @return Equipe le gagnant
+ */
+static Equipe rejouer_match(Equipe e1, Equipe e2, int tour, int num_match)
+{
+    partie p;
+    partie_debut(&p, e1, e2, tour, num_match);
+    while (p.temps < DUREE_MATCH)
+    {
+        partie_action(&p);
+    }
+    return partie_fin(&p);
+}
+
+/**
+ * @brief rejoue le match du tour tour qui utilise une place et qualifie son
+ * gagnant au tour suivant
+ *
+ * @param tour le tour
+ * @param place la place modifiée dans ce tour
+ * @param rejoues compteur des matchs rejoués
+ * @return int la place du gagnant au tour suivant s'il a changé, -1 sinon
+ */
+static int rejouer_etape(int tour, int place, int *rejoues)
+{
+    int num_match = place / 2;
+    Equipe e1 = pop_equipe_at_tour(&mon_tournoi, tour, 2 * num_match);
+    Equipe e2 = pop_equipe_at_tour(&mon_tournoi, tour, 2 * num_match + 1);
+    Equipe avant = pop_equipe_at_tour(&mon_tournoi, tour + 1, num_match);
+    int atteint_avant = (avant >= 0) ? mon_tournoi.parcours[avant].tour_atteint : 0;
+    Equipe eg;
+    if (e1 < 0 || e2 < 0)
+    {
+        eg = (e1 < 0) ? e2 : e1;    // exempt
+        mon_tournoi.parcours[eg].tour_atteint = tour + 1;
+    }
+    else
+    {
+        eg = rejouer_match(e1, e2, tour, num_match);
+        (*rejoues)++;
+    }
+    if (eg == avant)
+    {
+        // Même gagnant : la suite est inchangée, il garde le tour qu'il avait atteint
+        mon_tournoi.parcours[eg].tour_atteint = atteint_avant;
+        return -1;
+    }
+    inserer_equipe_tournoi(mon_tournoi, tour + 1, num_match, eg);
+    return num_match;
+}
+
+/**
+ * @brief Rejoue, dans un tournoi déjà joué, les matchs en aval d'une place
+ * modifiée (place du tour tour) : le match qui l'utilise, puis le suivant, etc.
+ * Chaque match garde son flux aléatoire, donc un match rejoué avec les mêmes
+ * equipes redonne le même gagnant : on s'arrête dés qu'un gagnant ne change
+ * pas, la suite du tournoi étant alors inchangée. Au plus nbr_tours matchs.
+ *
+ * @param tour tour de la place modifiée
+ * @param place la place modifiée
+ * @return int nombre de matchs rejoués
+ */
+int resimuler_depuis(int tour, int place)
+{
+    int rejoues = 0;
+    for (; tour < nbr_tours && place >= 0; tour++)
+    {
+        place = rejouer_etape(tour, place, &rejoues);
+    }
+    return rejoues;
+}
+
+/**
+ * @brief Et si : donne la victoire d'un match déjà joué à l'autre equipe, puis
+ * rejoue les matchs en aval (resimuler_depuis)
+ *
+ * @param tour tour du match
+ * @param num_match numéro du match dans le tour
+ * @return int nombre de matchs rejoués, -1 si le match n'existe pas ou n'a pas été joué
+ */
+int renverser_match(int tour, int num_match)
+{
+    if (tour < 0 || tour >= nbr_tours || num_match < 0 || num_match >= (mon_tournoi.taille >> (tour + 1)))
+    {
+        return -1;
+    }
+    Equipe e1 = pop_equipe_at_tour(&mon_tournoi, tour, 2 * num_match);
+    Equipe e2 = pop_equipe_at_tour(&mon_tournoi, tour, 2 * num_match + 1);
+    Equipe eg = pop_equipe_at_tour(&mon_tournoi, tour + 1, num_match);
+    if (e1 < 0 || e2 < 0 || eg < 0)
+    {
+        return -1;
+    }
+    resultat_match *r = &mon_tournoi.resultats[id_match(tour, num_match)];
+    noter_resultat(tour, num_match, (eg == e1) ? e2 : e1, eg, r->score_e1, r->score_e2, r->drapeaux ^ RESULTAT_RENVERSE);
+    inserer_equipe_tournoi(mon_tournoi, tour + 1, num_match, (eg == e1) ? e2 : e1);
+    return resimuler_depuis(tour + 1, num_match);
+}
+
+/**
+ * @brief Et si : une equipe prend une autre place du tour 0 d'un tournoi déjà
+ * joué, l'equipe de cette place prend la sienne. Les deux chemins sont rejoués
+ * tour par tour ensemble : quand l'un atteint un match, l'autre côté de ce
+ * match est déjà à jour, et un match où les chemins se rejoignent n'est rejoué
+ * qu'une fois.
+ *
+ * @param place la place au tour 0
+ * @param e l'equipe qui prend cette place
+ * @return int nombre de matchs rejoués, -1 si la place est vide ou n'existe pas
+ */
+int remplacer_equipe(int place, Equipe e)
+{
+    if (place < 0 || place >= mon_tournoi.taille || e < 0 || e >= mes_equipes.nbr)
+    {
+        return -1;
+    }
+    Equipe ancienne = pop_equipe_at_tour(&mon_tournoi, 0, place);
+    int autre = mon_tournoi.parcours[e].place;
+    if (ancienne < 0 || autre < 0)
+    {
+        return -1;
+    }
+    if (autre == place)
+    {
+        return 0;
+    }
+    inserer_equipe_tournoi(mon_tournoi, 0, place, e);
+    inserer_equipe_tournoi(mon_tournoi, 0, autre, ancienne);
+    mon_tournoi.parcours[e].place = place;
+    mon_tournoi.parcours[ancienne].place = autre;
+
+    // Places des deux chemins au tour courant, -1 quand un chemin ne change plus
+    int rejoues = 0;
+    for (int tour = 0; tour < nbr_tours && (place >= 0 || autre >= 0); tour++)
+    {
+        if (place >= 0 && autre >= 0 && place / 2 == autre / 2)
+        {
+            autre = -1;
+        }
+        if (place >= 0)
+        {
+            place = rejouer_etape(tour, place, &rejoues);
+        }
+        if (autre >= 0)
+        {
+            autre = rejouer_etape(tour, autre, &rejoues);
+        }
+    }
+    return rejoues;
+}
+
+/**
+ * @brief Parcours d'une equipe dans le tableau, sans parcourir les tours : sa
+ * place au tour 0 donne sa place à chaque tour (place >> tour), son adversaire
+ * est à la place voisine et le score est dans resultats. Le parcours est tenu
+ * à jour par les matchs (joués, repris d'une sauvegarde ou rejoués par les et si).
+ *
+ * @param e l'equipe
+ * @param etapes reçoit les étapes, au moins nbr_tours
+ * @return int nombre d'étapes (0 si l'equipe n'est pas dans le tableau)
+ */
+int parcours(Equipe e, etape *etapes)
+{
+    if (e < 0 || e >= mon_tournoi.taille || mon_tournoi.parcours[e].place < 0)
+    {
+        return 0;
+    }
+    const parcours_equipe *pe = &mon_tournoi.parcours[e];
+    int nbr = 0;
+    for (int tour = 0; tour <= pe->tour_atteint && tour < mon_tournoi.nbrTour; tour++)
+    {
+        int place = pe->place >> tour;
+        const resultat_match *r = &mon_tournoi.resultats[id_match(tour, place / 2)];
+        Equipe adversaire = mon_tournoi.tour[tour][place ^ 1];
+        if (adversaire >= 0 && !(r->drapeaux & RESULTAT_JOUE))
+        {
+            break;  // match pas encore joué
+        }
+        etape *et = &etapes[nbr++];
+        et->tour = tour;
+        et->adversaire = adversaire;
+        et->score_pour = (place & 1) ? r->score_e2 : r->score_e1;
+        et->score_contre = (place & 1) ? r->score_e1 : r->score_e2;
+        et->drapeaux = (adversaire >= 0) ? r->drapeaux : 0;
+        et->gagne = tour < pe->tour_atteint;
+    }
+    return nbr;
+}